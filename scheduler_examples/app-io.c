@@ -9,6 +9,7 @@
 
 #include "debug.h"
 
+#include "latency.h"
 #include "msg.h"
 #include "burst_queue.h"
 
@@ -44,7 +45,15 @@ process_status_en handle_process_requests(int sockfd, const pid_t pid, const cha
         .request = request,
         .time_ms = (request == PROCESS_REQUEST_RUN)?burst->burst_time_ms:burst->block_time_ms
     };
+    // The group is the OSSIM_GROUP environment variable, or the name of the application
+    const char *group = getenv("OSSIM_GROUP");
+    snprintf(msg.group, sizeof(msg.group), "%s", group ? group : app_name);
+    if (request == PROCESS_REQUEST_BLOCK) {
+        memcpy(msg.device, burst->device, sizeof(msg.device));
+        msg.position = burst->position;
+    }
     // Send request
+    uint64_t sent_ns = latency_now_ns();
     if (write(sockfd, &msg, sizeof(msg_t)) != sizeof(msg_t)) {
         perror("write");
         close(sockfd);
@@ -62,6 +71,8 @@ process_status_en handle_process_requests(int sockfd, const pid_t pid, const cha
         printf("Received invalid request. Expected ACK, received %s\n", PROCESS_REQUEST_STRINGS[msg.request]);
         return process_error;
     }
+    latency_record(request == PROCESS_REQUEST_RUN ? LATENCY_RUN_ACK : LATENCY_BLOCK_ACK,
+                   latency_now_ns() - sent_ns);
     *sim_clock_ms = msg.time_ms;
     if (*sim_start_time_ms == 0) *sim_start_time_ms = *sim_clock_ms; // First burst, set the start time
     DBG("Received %s from scheduler for application %s (PID %d) at time %u ms\n",
@@ -78,6 +89,7 @@ process_status_en handle_process_requests(int sockfd, const pid_t pid, const cha
         printf("Received invalid request. Expected DONE, received %s\n", PROCESS_REQUEST_STRINGS[msg.request]);
         return process_error;
     }
+    latency_record_since(LATENCY_DONE, msg.sent_ns);
     *sim_clock_ms = msg.time_ms;
     DBG("Received %s from scheduler for application %s (PID %d) at time %u ms\n",
            PROCESS_REQUEST_STRINGS[msg.request], app_name, pid, *sim_clock_ms);
@@ -86,7 +98,7 @@ process_status_en handle_process_requests(int sockfd, const pid_t pid, const cha
 }
 
 /*
- * Run like: ./app-pre <burst-file.csv>
+ * Run like: [OSSIM_GROUP=group] ./app-io <burst-file.csv>
  */
 int main(int argc, char *argv[]) {
     if (argc != 2) {
@@ -150,6 +162,8 @@ int main(int argc, char *argv[]) {
 
     printf("Application %s (PID %d) finished at time %d ms, Elapsed: %.03f seconds, CPU: %.03f seconds, BLOCKED: %.03f seconds\n",
            app_name, pid, sim_clock_ms, real, user, sys);
+    latency_print(stdout, app_name, pid);
+    latency_export(app_name, pid);
 
     close(sockfd);
     free(app_name);
@@ -9,14 +9,18 @@
 
 #include "debug.h"
 
+#include "latency.h"
 #include "msg.h"
 
 /*
- * Run like: ./app <name> <time_s>
+ * Run like: ./app <name> <time_s> [cpus]
+ * With cpus > 1, the application is a parallel job that needs that many CPUs at the same time.
+ * The application belongs to the group in the OSSIM_GROUP environment variable, or to a group
+ * with its own name.
  */
 int main(int argc, char *argv[]) {
-    if (argc != 3) {
-        printf("Usage: %s <name> <time_s>\n", argv[0]);
+    if (argc != 3 && argc != 4) {
+        printf("Usage: %s <name> <time_s> [cpus]\n", argv[0]);
         exit(EXIT_FAILURE);
     }
 
@@ -39,6 +43,17 @@ int main(int argc, char *argv[]) {
     }
     int32_t time_s = (int32_t) val;
 
+    uint32_t parallelism = 1;
+    if (argc == 4) {
+        errno = 0;
+        val = strtol(argv[3], &endptr, 10);
+        if (errno != 0 || *endptr != '\0' || val < 1 || val > INT_MAX) {
+            fprintf(stderr, "Invalid number of CPUs: %s\n", argv[3]);
+            return 1;
+        }
+        parallelism = (uint32_t) val;
+    }
+
     // Setup socket for communication
     int sockfd = socket(AF_UNIX, SOCK_STREAM, 0);
     if (sockfd < 0) {
@@ -64,8 +79,12 @@ int main(int argc, char *argv[]) {
     msg_t msg = {
         .pid = pid,
         .request = PROCESS_REQUEST_RUN,
-        .time_ms = time_s * 1000
+        .time_ms = time_s * 1000,
+        .parallelism = parallelism
     };
+    const char *group = getenv("OSSIM_GROUP");
+    snprintf(msg.group, sizeof(msg.group), "%s", group ? group : app_name);
+    uint64_t sent_ns = latency_now_ns();
     if (write(sockfd, &msg, sizeof(msg_t)) != sizeof(msg_t)) {
         perror("write");
         close(sockfd);
@@ -83,6 +102,7 @@ int main(int argc, char *argv[]) {
         printf("Received invalid request. Expected ACK\n");
         return EXIT_FAILURE;
     }
+    latency_record(LATENCY_RUN_ACK, latency_now_ns() - sent_ns);
 
     // Received ACK
     uint32_t start_time_ms = msg.time_ms;
@@ -97,6 +117,7 @@ int main(int argc, char *argv[]) {
     if (msg.request != PROCESS_REQUEST_DONE) {
         printf("Received invalid request. Expected EXIT\n");
     }
+    latency_record_since(LATENCY_DONE, msg.sent_ns);
 
     // Received EXIT, print stats
     double real = (msg.time_ms - start_time_ms)/1000.0;
@@ -105,6 +126,8 @@ int main(int argc, char *argv[]) {
 
     printf("Application %s (PID %d) finished at time %d ms, Elapsed: %.03f seconds, CPU: %.03f seconds\n",
            app_name, pid, msg.time_ms, real, user);
+    latency_print(stdout, app_name, pid);
+    latency_export(app_name, pid);
 
     close(sockfd);
     return EXIT_SUCCESS;
@@ -34,16 +34,37 @@ int parse_burst_line(const char* line, burst_t* burst) {
     }
     burst->burst_time_ms = (int)burst_time;
 
-    // Optional: block time
+    // Optional: block time, with the device and position of the block as time@device[:position]
     token = strtok(NULL, ",\r\n");
     if (token) {
         long block_time_ms = strtol(token, &endptr, 10);
-        if (*endptr != '\0' || block_time_ms < INT_MIN || block_time_ms > INT_MAX) {
+        if ((*endptr != '\0' && *endptr != '@') || block_time_ms < INT_MIN || block_time_ms > INT_MAX) {
             fprintf(stderr, "Invalid block time value: %s\n", token);
             free(line_copy);
             return -1;
         }
         burst->block_time_ms = (int)block_time_ms;
+        if (*endptr == '@') {
+            char *device = endptr + 1;
+            char *colon = strchr(device, ':');
+            size_t len = colon ? (size_t)(colon - device) : strlen(device);
+            if (len >= sizeof(burst->device)) {
+                fprintf(stderr, "Invalid block device: %s\n", token);
+                free(line_copy);
+                return -1;
+            }
+            memcpy(burst->device, device, len);
+            burst->device[len] = '\0';
+            if (colon) {
+                long position = strtol(colon + 1, &endptr, 10);
+                if (*endptr != '\0' || endptr == colon + 1 || position < 0 || position > INT_MAX) {
+                    fprintf(stderr, "Invalid block position: %s\n", token);
+                    free(line_copy);
+                    return -1;
+                }
+                burst->position = (uint32_t)position;
+            }
+        }
     }
 
     // Optional: parse nice
@@ -7,6 +7,8 @@ typedef struct {
     uint32_t burst_time_ms;         // Burst time in milliseconds
     uint32_t block_time_ms;         // Burst time in milliseconds
     int nice;                       // Nice value (priority)
+    char device[MSG_DEVICE_LEN];    // I/O device of the block, empty for the device chosen by PID
+    uint32_t position;              // Position of the block on the device
     page_info_t pages;
 } burst_t;
 
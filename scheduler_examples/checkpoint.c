@@ -0,0 +1,225 @@
+#include "checkpoint.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cpu.h"
+#include "group.h"
+#include "hotplug.h"
+#include "iodev.h"
+#include "mlfq.h"
+#include "netio.h"
+#include "power.h"
+#include "replay.h"
+#include "stats.h"
+#include "tasktab.h"
+
+#define CKPT_MAGIC "OSSIMCKP"
+#define CKPT_VERSION 15
+// Written instead of a pcb index for a NULL reference
+#define CKPT_NULL_PCB UINT32_MAX
+
+struct checkpoint_st {
+    FILE *file;
+    int restoring;
+    int failed;
+    pcb_t **pcbs;           // pcbs transferred so far, by index
+    uint32_t num_pcbs;
+    uint32_t max_pcbs;
+};
+
+int ckpt_restoring(const checkpoint_t *ck) {
+    return ck->restoring;
+}
+
+void ckpt_fail(checkpoint_t *ck, const char *reason) {
+    if (!ck->failed) fprintf(stderr, "Checkpoint: %s\n", reason);
+    ck->failed = 1;
+}
+
+void ckpt_bytes(checkpoint_t *ck, void *data, size_t size) {
+    if (ck->failed) {
+        if (ck->restoring) memset(data, 0, size);
+        return;
+    }
+    size_t done = ck->restoring ? fread(data, 1, size, ck->file) : fwrite(data, 1, size, ck->file);
+    if (done != size) {
+        ckpt_fail(ck, ck->restoring ? "the file is truncated" : "write failed");
+        if (ck->restoring) memset(data, 0, size);
+    }
+}
+
+void ckpt_u32(checkpoint_t *ck, uint32_t *value) {
+    ckpt_bytes(ck, value, sizeof(*value));
+}
+
+static int add_pcb(checkpoint_t *ck, pcb_t *pcb) {
+    if (ck->num_pcbs == ck->max_pcbs) {
+        uint32_t new_max = ck->max_pcbs ? ck->max_pcbs * 2 : 64;
+        pcb_t **tmp = realloc(ck->pcbs, new_max * sizeof(pcb_t *));
+        if (!tmp) {
+            perror("realloc");
+            ckpt_fail(ck, "out of memory");
+            return -1;
+        }
+        ck->pcbs = tmp;
+        ck->max_pcbs = new_max;
+    }
+    ck->pcbs[ck->num_pcbs++] = pcb;
+    return 0;
+}
+
+void ckpt_pcb(checkpoint_t *ck, pcb_t **pcb) {
+    uint32_t index = CKPT_NULL_PCB;
+    if (!ck->restoring) {
+        if (*pcb != NULL) {
+            for (index = 0; index < ck->num_pcbs && ck->pcbs[index] != *pcb; index++);
+        }
+        ckpt_u32(ck, &index);
+        // First reference: the contents follow the index
+        if (index == ck->num_pcbs && add_pcb(ck, *pcb) == 0) {
+            ckpt_bytes(ck, *pcb, sizeof(pcb_t));
+        }
+        return;
+    }
+
+    *pcb = NULL;
+    ckpt_u32(ck, &index);
+    if (ck->failed || index == CKPT_NULL_PCB) return;
+    if (index < ck->num_pcbs) {
+        *pcb = ck->pcbs[index];
+    } else if (index == ck->num_pcbs) {
+        pcb_t *p = malloc(sizeof(pcb_t));
+        if (!p) {
+            perror("malloc");
+            ckpt_fail(ck, "out of memory");
+            return;
+        }
+        ckpt_bytes(ck, p, sizeof(pcb_t));
+        if (add_pcb(ck, p) != 0) {
+            free(p);
+            return;
+        }
+        *pcb = p;
+    } else {
+        ckpt_fail(ck, "invalid task reference");
+    }
+}
+
+void ckpt_queue(checkpoint_t *ck, queue_t *q) {
+    uint32_t size = (uint32_t)q->size;
+    ckpt_u32(ck, &size);
+    if (!ck->restoring) {
+        for (queue_elem_t *elem = q->head; elem != NULL; elem = elem->next) {
+            ckpt_pcb(ck, &elem->pcb);
+        }
+        return;
+    }
+    for (uint32_t i = 0; i < size && !ck->failed; i++) {
+        pcb_t *pcb;
+        ckpt_pcb(ck, &pcb);
+        if (pcb != NULL) enqueue_pcb(q, pcb);
+    }
+}
+
+int ckpt_event_queue(checkpoint_t *ck, mpsc_queue_t *q) {
+    uint32_t count = 0;
+    if (!ck->restoring) {
+        // Pop all the events to write them, then push them back in the same order
+        mpsc_queue_t tmp;
+        mpsc_init(&tmp);
+        mpsc_node_t *node;
+        while ((node = mpsc_pop(q)) != NULL) {
+            mpsc_push(&tmp, node);
+            count++;
+        }
+        ckpt_u32(ck, &count);
+        while ((node = mpsc_pop(&tmp)) != NULL) {
+            net_event_t *event = (net_event_t *)node;
+            ckpt_bytes(ck, &event->type, sizeof(event->type));
+            ckpt_bytes(ck, &event->sockfd, sizeof(event->sockfd));
+            ckpt_bytes(ck, &event->msg, sizeof(event->msg));
+            mpsc_push(q, node);
+        }
+        return (int)count;
+    }
+
+    ckpt_u32(ck, &count);
+    for (uint32_t i = 0; i < count && !ck->failed; i++) {
+        net_event_t *event = calloc(1, sizeof(net_event_t));
+        if (!event) {
+            perror("calloc");
+            ckpt_fail(ck, "out of memory");
+            return -1;
+        }
+        ckpt_bytes(ck, &event->type, sizeof(event->type));
+        ckpt_bytes(ck, &event->sockfd, sizeof(event->sockfd));
+        ckpt_bytes(ck, &event->msg, sizeof(event->msg));
+        mpsc_push(q, &event->node);
+    }
+    return (int)count;
+}
+
+// Transfer the state of the simulator, in the same order for saving and restoring
+static void transfer(checkpoint_t *ck, const sim_state_t *state) {
+    char magic[sizeof(CKPT_MAGIC)] = CKPT_MAGIC;
+    uint32_t version = CKPT_VERSION;
+    uint32_t num_cpus = (uint32_t)state->num_cpus;
+    ckpt_bytes(ck, magic, sizeof(magic));
+    ckpt_u32(ck, &version);
+    ckpt_u32(ck, &num_cpus);
+    if (memcmp(magic, CKPT_MAGIC, sizeof(magic)) != 0 || version != CKPT_VERSION) {
+        ckpt_fail(ck, "not a checkpoint of this version of the simulator");
+    } else if (num_cpus != (uint32_t)state->num_cpus) {
+        ckpt_fail(ck, "the checkpoint was saved with a different number of CPUs");
+    }
+
+    ckpt_u32(ck, state->current_time_ms);
+    ckpt_u32(ck, state->next_pid);
+    ckpt_queue(ck, state->command_queue);
+    ckpt_queue(ck, state->ready_queue);
+    task_table_checkpoint(state->blocked_tasks, ck);
+    for (int i = 0; i < state->num_cpus; i++) {
+        ckpt_pcb(ck, &state->cpus[i]);
+    }
+    *state->num_deferred_events = ckpt_event_queue(ck, state->deferred_events);
+
+    cpu_checkpoint(ck);
+    io_checkpoint(ck);
+    power_checkpoint(ck);
+    mlfq_checkpoint(ck);
+    netio_checkpoint(ck);
+    replay_checkpoint(ck);
+    stats_checkpoint(ck);
+    group_checkpoint(ck);
+    hotplug_checkpoint(ck);
+
+    // The magic again at the end, to detect files that do not match the configuration
+    memcpy(magic, CKPT_MAGIC, sizeof(magic));
+    ckpt_bytes(ck, magic, sizeof(magic));
+    if (memcmp(magic, CKPT_MAGIC, sizeof(magic)) != 0) {
+        ckpt_fail(ck, "the checkpoint does not match the configuration");
+    }
+}
+
+static int run(const char *path, const sim_state_t *state, int restoring) {
+    checkpoint_t ck = {.restoring = restoring};
+    ck.file = fopen(path, restoring ? "rb" : "wb");
+    if (ck.file == NULL) {
+        perror("fopen");
+        return -1;
+    }
+    transfer(&ck, state);
+    if (fclose(ck.file) != 0 && !restoring) ckpt_fail(&ck, "write failed");
+    free(ck.pcbs);
+    return ck.failed ? -1 : 0;
+}
+
+int checkpoint_save(const char *path, const sim_state_t *state) {
+    return run(path, state, 0);
+}
+
+int checkpoint_restore(const char *path, const sim_state_t *state) {
+    return run(path, state, 1);
+}
@@ -0,0 +1,109 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "mpsc.h"
+#include "queue.h"
+
+typedef struct task_table_st task_table_t;
+
+/*
+ * Checkpoint and restore of the simulator state.
+ * A checkpoint is a binary file with everything the simulation needs to continue:
+ * the clock, the queues, the CPUs and the state kept by each module (I/O devices,
+ * frequency and idle states, MLFQ levels, virtual applications, statistics...).
+ * Each module transfers its own state with a *_checkpoint() function that uses
+ * the ckpt_*() functions below, which write the values when saving and read them
+ * back when restoring, so the same code describes both directions.
+ *
+ * The socket connections cannot be saved, so checkpoints are only available when
+ * replaying a scenario (the virtual applications are part of the state). The
+ * parameters, governor and scheduler are not saved: a checkpoint can be restored
+ * with different ones to compare variants from the same warm state.
+ */
+
+typedef struct checkpoint_st checkpoint_t;
+
+// State of the main loop of the simulator
+typedef struct {
+    uint32_t *current_time_ms;
+    uint32_t *next_pid;             // Last PID given to a new connection
+    queue_t *command_queue;
+    queue_t *ready_queue;
+    task_table_t *blocked_tasks;    // I/O requests being served
+    pcb_t **cpus;
+    int num_cpus;
+    mpsc_queue_t *deferred_events;  // Events waiting for their task to return to the command queue
+    int *num_deferred_events;
+} sim_state_t;
+
+/**
+ * @brief Save the state of the simulator to a file
+ *
+ * @param path  The path of the checkpoint
+ * @param state The state of the main loop
+ * @return 0 on success, -1 on failure
+ */
+int checkpoint_save(const char *path, const sim_state_t *state);
+
+/**
+ * @brief Restore the state of the simulator from a file
+ *
+ * Must be called after the scenario is loaded, before the first tick. The topology
+ * and the I/O devices must be the same as when the checkpoint was saved.
+ *
+ * @param path  The path of the checkpoint
+ * @param state The state of the main loop, empty
+ * @return 0 on success, -1 on failure
+ */
+int checkpoint_restore(const char *path, const sim_state_t *state);
+
+/**
+ * @brief Check if the checkpoint is being restored (1) or saved (0)
+ */
+int ckpt_restoring(const checkpoint_t *ck);
+
+/**
+ * @brief Mark the checkpoint as invalid (e.g. it does not match the configuration)
+ *
+ * @param ck     The checkpoint
+ * @param reason Message printed for the user
+ */
+void ckpt_fail(checkpoint_t *ck, const char *reason);
+
+/**
+ * @brief Transfer a block of plain data (no pointers)
+ */
+void ckpt_bytes(checkpoint_t *ck, void *data, size_t size);
+
+/**
+ * @brief Transfer a 32-bit value
+ */
+void ckpt_u32(checkpoint_t *ck, uint32_t *value);
+
+/**
+ * @brief Transfer a reference to a pcb
+ *
+ * Each pcb is written once, the first time it is referenced, so a pcb in several
+ * places (e.g. a parallel task on several CPUs) is restored as a single pcb.
+ *
+ * @param ck  The checkpoint
+ * @param pcb The reference (may be NULL), set when restoring
+ */
+void ckpt_pcb(checkpoint_t *ck, pcb_t **pcb);
+
+/**
+ * @brief Transfer the pcbs of a queue, in order (the queue must be empty when restoring)
+ */
+void ckpt_queue(checkpoint_t *ck, queue_t *q);
+
+/**
+ * @brief Transfer the network events of a queue, in order (the queue must be empty when restoring)
+ *
+ * @return The number of events
+ */
+int ckpt_event_queue(checkpoint_t *ck, mpsc_queue_t *q);
+
+#endif // CHECKPOINT_H
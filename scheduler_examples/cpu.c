@@ -0,0 +1,254 @@
+#include "cpu.h"
+
+#include <stdio.h>
+
+#include "debug.h"
+#include "emulate.h"
+#include "probes.h"
+#include "msg.h"
+#include "netio.h"
+#include "params.h"
+#include "power.h"
+#include "stats.h"
+
+// Context switch time still to be paid on each CPU before the task advances
+static uint32_t switch_left_ms[MAX_CPUS] = {0};
+
+// Fraction of a millisecond (in 1/100 ms) of progress not yet credited to the task on each CPU
+static uint32_t progress_frac[MAX_CPUS] = {0};
+
+// Last task placed on each CPU, 0 if none yet
+static int32_t last_pid[MAX_CPUS] = {0};
+
+// Tasks that finished their CPU burst since the last call to cpu_collect_finished()
+static queue_t finished_queue = {.head = NULL, .tail = NULL};
+
+uint32_t cpu_remaining_ms(const pcb_t *p) {
+    return (p->time_ms > p->ellapsed_time_ms) ? p->time_ms - p->ellapsed_time_ms : 0;
+}
+
+int cpu_first_free(pcb_t **cpus, int num_cpus) {
+    for (int i = 0; i < num_cpus; i++) {
+        if (cpus[i] == NULL) return i;
+    }
+    return -1;
+}
+
+int cpu_select(const pcb_t *p, pcb_t **cpus, int num_cpus) {
+    if (cpu_first_free(cpus, num_cpus) < 0) return -1;  // No CPU available
+
+    int last = p->last_cpu;
+    if (last >= num_cpus) last = -1;
+
+    // On heterogeneous CPUs, long bursts belong on the big cores and short ones on the little cores
+    int heterogeneous = topo_is_heterogeneous();
+    uint32_t want_capacity = 0;
+    if (heterogeneous) {
+        want_capacity = (cpu_remaining_ms(p) >= sim_params.big_burst_ms) ? topo_max_capacity() : topo_min_capacity();
+    }
+
+    if (last >= 0 && (!heterogeneous || topo_capacity(last) == want_capacity)) {
+        if (cpus[last] == NULL) return last;
+
+        // The previous CPU is busy, wait for it if it will be free soon
+        if (cpu_remaining_ms(cpus[last]) <= sim_params.affinity_wait_ms) {
+            return -1;
+        }
+    }
+
+    // Choose the free CPU with the lowest cost: close to the previous CPU (or on the
+    // least loaded node for a new task), and without busy SMT siblings
+    int best = -1;
+    int best_cost = 0;
+    for (int i = 0; i < num_cpus; i++) {
+        if (cpus[i] != NULL) continue;
+        int placement = (last >= 0) ? (int)topo_distance(last, i) : topo_socket_load(cpus, topo_socket(i));
+        int cost = placement * (MAX_CPUS + 1) + topo_busy_siblings(cpus, i);
+        // Consolidation: waking a sleeping CPU costs more than any placement
+        if (sim_params.power_consolidate && power_is_deep_idle(i)) cost += (TOPO_REMOTE + 1) * (MAX_CPUS + 1);
+        // Capacity: each percent away from the wanted capacity costs more than any placement
+        if (heterogeneous) {
+            uint32_t capacity = topo_capacity(i);
+            uint32_t mismatch = (capacity > want_capacity) ? capacity - want_capacity : want_capacity - capacity;
+            cost += (int)mismatch * (TOPO_REMOTE + 1) * (MAX_CPUS + 1);
+        }
+        if (best < 0 || cost < best_cost) {
+            best = i;
+            best_cost = cost;
+        }
+    }
+    return best;
+}
+
+// Burst time charged to a task that moves between two CPUs
+static uint32_t migration_penalty(int from, int to) {
+    switch (topo_distance(from, to)) {
+        case TOPO_SAME_CPU:
+        case TOPO_SMT:
+            return 0;   // The core caches are shared
+        case TOPO_SAME_NODE:
+            return sim_params.migration_penalty_ms;
+        case TOPO_REMOTE:
+        default:
+            return sim_params.remote_migration_penalty_ms;
+    }
+}
+
+// Start the context switch of a CPU to the task just placed on it. Only a CPU that last ran
+// another task pays the switch, so a task dispatched again where it just ran (a new quantum,
+// a new MLFQ level) costs nothing but the wake-up of the CPU.
+static void cpu_switch(const pcb_t *p, int cpu) {
+    switch_left_ms[cpu] = power_wake(cpu);
+    progress_frac[cpu] = 0;
+    STAT_ADD(dispatches, 1);
+    if (last_pid[cpu] != p->pid) {
+        switch_left_ms[cpu] += sim_params.context_switch_ms;
+        STAT_ADD(context_switches, 1);
+        last_pid[cpu] = p->pid;
+    }
+}
+
+void cpu_dispatch(pcb_t *p, pcb_t **cpus, int cpu, uint32_t current_time_ms) {
+    PROBE4(dispatch, p->pid, cpu, p->last_cpu, current_time_ms);
+    if (p->last_cpu >= 0 && p->last_cpu != cpu) {
+        uint32_t penalty = migration_penalty(p->last_cpu, cpu);
+        DBG("Process %d migrated from CPU %d to CPU %d at time %u ms (penalty %u ms)\n",
+            p->pid, p->last_cpu, cpu, current_time_ms, penalty);
+        p->time_ms += penalty;
+        STAT_ADD(migrations, 1);
+        if (topo_socket(p->last_cpu) != topo_socket(cpu)) {
+            STAT_ADD(remote_migrations, 1);
+        }
+        STAT_ADD(migration_penalty_ms, penalty);
+    }
+    p->last_cpu = cpu;
+    p->status = TASK_RUNNING;
+    p->ellapsed_time_ms = 0;
+    p->slice_start_ms = current_time_ms;
+    cpus[cpu] = p;
+    cpu_switch(p, cpu);
+}
+
+// Move a running task to another CPU, keeping its time slice
+static void cpu_move(pcb_t *p, pcb_t **cpus, int from, int to, uint32_t current_time_ms) {
+    uint32_t penalty = migration_penalty(from, to);
+    DBG("Process %d moved from CPU %d (capacity %u%%) to CPU %d (capacity %u%%) at time %u ms\n",
+        p->pid, from, topo_capacity(from), to, topo_capacity(to), current_time_ms);
+    p->time_ms += penalty;
+    p->last_cpu = to;
+    STAT_ADD(migrations, 1);
+    if (topo_socket(from) != topo_socket(to)) {
+        STAT_ADD(remote_migrations, 1);
+    }
+    STAT_ADD(migration_penalty_ms, penalty);
+    cpus[to] = p;
+    cpu_switch(p, to);
+}
+
+void cpu_rebalance(pcb_t **cpus, int num_cpus, uint32_t current_time_ms) {
+    if (!topo_is_heterogeneous()) return;
+    for (int i = 0; i < num_cpus; i++) {
+        pcb_t *p = cpus[i];
+        if (p == NULL || p->parallelism > 1 || cpu_remaining_ms(p) < sim_params.big_burst_ms) continue;
+
+        // The biggest idle core, or else the biggest core running a short burst
+        int idle = -1, busy = -1;
+        for (int j = 0; j < num_cpus; j++) {
+            if (topo_capacity(j) <= topo_capacity(i)) continue;
+            pcb_t *q = cpus[j];
+            if (q == NULL) {
+                if (idle < 0 || topo_capacity(j) > topo_capacity(idle)) idle = j;
+            } else if (q->parallelism <= 1 && cpu_remaining_ms(q) < sim_params.big_burst_ms) {
+                if (busy < 0 || topo_capacity(j) > topo_capacity(busy)) busy = j;
+            }
+        }
+        if (idle >= 0) {
+            cpu_move(p, cpus, i, idle, current_time_ms);
+            cpus[i] = NULL;
+            STAT_ADD(up_migrations, 1);
+        } else if (busy >= 0) {
+            pcb_t *q = cpus[busy];
+            cpu_move(p, cpus, i, busy, current_time_ms);
+            cpu_move(q, cpus, busy, i, current_time_ms);
+            STAT_ADD(up_migrations, 1);
+            STAT_ADD(down_migrations, 1);
+        }
+    }
+}
+
+void cpu_dispatch_gang(pcb_t *p, pcb_t **cpus, const int *cpu_list, int n, uint32_t current_time_ms) {
+    cpu_dispatch(p, cpus, cpu_list[0], current_time_ms);
+    for (int k = 1; k < n; k++) {
+        int cpu = cpu_list[k];
+        cpus[cpu] = p;
+        cpu_switch(p, cpu);
+    }
+}
+
+void cpu_burst_done(pcb_t **cpus, int cpu, uint32_t current_time_ms) {
+    pcb_t *p = cpus[cpu];
+    // Slowdown: response time over the requested time, bounded below by slowdown_bound_ms
+    // for the bounded slowdown, so very short bursts do not dominate the mean
+    if (p->burst_ms > 0) {
+        uint64_t response_ms = current_time_ms - p->request_ms;
+        STAT_ADD(response_ms, response_ms);
+        uint64_t bound_ms = (p->burst_ms > sim_params.slowdown_bound_ms) ? p->burst_ms : sim_params.slowdown_bound_ms;
+        uint64_t bounded_milli = response_ms * 1000 / (bound_ms ? bound_ms : 1);
+        STAT_ADD(bursts_done, 1);
+        STAT_ADD(slowdown_milli, response_ms * 1000 / p->burst_ms);
+        STAT_ADD(bounded_slowdown_milli, bounded_milli > 1000 ? bounded_milli : 1000);
+    }
+    msg_t done_msg = {
+        .pid = p->pid,
+        .request = PROCESS_REQUEST_DONE,
+        .time_ms = current_time_ms - p->clock_offset_ms
+    };
+    netio_send(p->sockfd, &done_msg);
+    PROBE3(done_sent, p->pid, 0, current_time_ms);
+
+    p->status = TASK_COMMAND;
+    p->ellapsed_time_ms = 0;
+    p->last_update_time_ms = current_time_ms;
+    cpus[cpu] = NULL;
+    enqueue_pcb(&finished_queue, p);
+}
+
+void cpu_collect_finished(queue_t *command_queue) {
+    pcb_t *p;
+    while ((p = dequeue_pcb(&finished_queue)) != NULL) {
+        enqueue_pcb(command_queue, p);
+    }
+}
+
+uint32_t cpu_run_tick(pcb_t **cpus, int cpu) {
+    uint32_t overhead = (switch_left_ms[cpu] < TICKS_MS) ? switch_left_ms[cpu] : TICKS_MS;
+    switch_left_ms[cpu] -= overhead;
+    STAT_ADD(switch_overhead_ms, overhead);
+
+    // Busy SMT siblings compete for the same core
+    uint32_t slowdown_pct = sim_params.smt_slowdown_pct * (uint32_t)topo_busy_siblings(cpus, cpu);
+    if (slowdown_pct > 100) slowdown_pct = 100;
+    progress_frac[cpu] += (TICKS_MS - overhead) * (100 - slowdown_pct) * topo_capacity(cpu) / 100
+                          * power_speed_pct(cpu) / 100;
+    uint32_t progress = progress_frac[cpu] / 100;
+    progress_frac[cpu] %= 100;
+    if (emulate_active()) emulate_run(cpu, cpus[cpu]->pid, progress);
+    return progress;
+}
+
+void cpu_account_tick(pcb_t **cpus, int num_cpus) {
+    for (int i = 0; i < num_cpus; i++) {
+        if (cpus[i] != NULL) {
+            STAT_ADD(cpu_busy_ms[i], TICKS_MS);
+        } else {
+            STAT_ADD(cpu_idle_ms[i], TICKS_MS);
+        }
+    }
+}
+
+void cpu_checkpoint(checkpoint_t *ck) {
+    ckpt_bytes(ck, switch_left_ms, sizeof(switch_left_ms));
+    ckpt_bytes(ck, progress_frac, sizeof(progress_frac));
+    ckpt_bytes(ck, last_pid, sizeof(last_pid));
+    ckpt_queue(ck, &finished_queue);
+}
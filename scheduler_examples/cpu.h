@@ -0,0 +1,142 @@
+#ifndef CPU_H
+#define CPU_H
+
+#include <stdint.h>
+#include "checkpoint.h"
+#include "queue.h"
+#include "topology.h"
+
+/**
+ * @brief Remaining CPU time of the current burst of a task
+ *
+ * @param p The task
+ * @return The time in milliseconds the task still needs to finish its burst
+ */
+uint32_t cpu_remaining_ms(const pcb_t *p);
+
+/**
+ * @brief Find the first idle CPU
+ *
+ * @param cpus     Array with the task running on each CPU (NULL if idle)
+ * @param num_cpus Number of CPUs
+ * @return The index of the first idle CPU, or -1 if all CPUs are busy
+ */
+int cpu_first_free(pcb_t **cpus, int num_cpus);
+
+/**
+ * @brief Select the CPU where a task should be dispatched
+ *
+ * The CPU where the task ran last is preferred, because its cache is still warm.
+ * If that CPU is busy but the task running there will finish within
+ * sim_params.affinity_wait_ms, the task should wait for it instead of migrating.
+ * Otherwise, the free CPU closest to the previous one in the topology is returned
+ * (SMT sibling, then the same node). Tasks that never ran go to the least loaded
+ * node. In both cases, CPUs on an idle core are preferred to SMT siblings of busy CPUs.
+ * On heterogeneous CPUs, the capacity comes first: bursts of at least
+ * sim_params.big_burst_ms go to the biggest free core, and shorter bursts to the
+ * smallest one, even if the previous CPU of the task is free.
+ *
+ * @param p        The task to be dispatched
+ * @param cpus     Array with the task running on each CPU (NULL if idle)
+ * @param num_cpus Number of CPUs
+ * @return The index of the CPU to use, or -1 if the task should not be dispatched now
+ */
+int cpu_select(const pcb_t *p, pcb_t **cpus, int num_cpus);
+
+/**
+ * @brief Place a task on a CPU
+ *
+ * The task starts a new time slice on the CPU. If the task ran on another CPU
+ * before, it pays a migration penalty as extra burst time: nothing for an SMT
+ * sibling, sim_params.migration_penalty_ms within the same node, and
+ * sim_params.remote_migration_penalty_ms across nodes. The migration is accounted
+ * in the statistics.
+ *
+ * @param p               The task to be dispatched
+ * @param cpus            Array with the task running on each CPU (NULL if idle)
+ * @param cpu             The index of the CPU where the task will run
+ * @param current_time_ms Current simulation time in milliseconds
+ */
+void cpu_dispatch(pcb_t *p, pcb_t **cpus, int cpu, uint32_t current_time_ms);
+
+/**
+ * @brief Move running tasks between cores of different capacity (heterogeneous CPUs only)
+ *
+ * A task on a smaller core with at least sim_params.big_burst_ms left moves up to
+ * an idle bigger core. If there is none, it swaps with a task on a bigger core that
+ * has less than sim_params.big_burst_ms left, which moves down. The moved tasks
+ * keep their time slice, but pay the migration penalty and a context switch.
+ * Parallel tasks are not moved.
+ *
+ * @param cpus            Array with the task running on each CPU (NULL if idle)
+ * @param num_cpus        Number of CPUs
+ * @param current_time_ms Current simulation time in milliseconds
+ */
+void cpu_rebalance(pcb_t **cpus, int num_cpus, uint32_t current_time_ms);
+
+/**
+ * @brief Place a parallel task on several CPUs at the same time (gang)
+ *
+ * The first CPU of the list becomes the CPU of the task (last_cpu), and the
+ * migration penalty is charged once, as for cpu_dispatch(). Every CPU of the
+ * list pays the context switch.
+ *
+ * @param p               The task to be dispatched
+ * @param cpus            Array with the task running on each CPU (NULL if idle)
+ * @param cpu_list        The indexes of the CPUs where the task will run
+ * @param n               Number of CPUs in the list
+ * @param current_time_ms Current simulation time in milliseconds
+ */
+void cpu_dispatch_gang(pcb_t *p, pcb_t **cpus, const int *cpu_list, int n, uint32_t current_time_ms);
+
+/**
+ * @brief Finish the CPU burst of the task running on a CPU
+ *
+ * A DONE message is sent to the application, the CPU becomes idle and the task
+ * waits to be moved to the command queue by cpu_collect_finished().
+ *
+ * @param cpus            Array with the task running on each CPU (NULL if idle)
+ * @param cpu             The index of the CPU where the burst finished
+ * @param current_time_ms Current simulation time in milliseconds
+ */
+void cpu_burst_done(pcb_t **cpus, int cpu, uint32_t current_time_ms);
+
+/**
+ * @brief Move the tasks that finished their CPU burst to the command queue
+ *
+ * @param command_queue The queue where the tasks will wait for their next request
+ */
+void cpu_collect_finished(queue_t *command_queue);
+
+/**
+ * @brief Run the task on a CPU for one tick
+ *
+ * After a dispatch on a CPU that last ran another task, the CPU first spends
+ * sim_params.context_switch_ms switching to the task. That time is consumed from the tick without advancing the task,
+ * and accounted as overhead in the statistics. While SMT siblings of the CPU are
+ * busy, they share the core, and the task advances sim_params.smt_slowdown_pct
+ * slower for each busy sibling. The progress is also scaled by the capacity of
+ * the core and its current frequency.
+ *
+ * @param cpus Array with the task running on each CPU (NULL if idle)
+ * @param cpu  The index of the CPU
+ * @return The time in milliseconds the task on the CPU advanced during this tick
+ */
+uint32_t cpu_run_tick(pcb_t **cpus, int cpu);
+
+/**
+ * @brief Account one tick of busy or idle time on each CPU
+ *
+ * @param cpus     Array with the task running on each CPU (NULL if idle)
+ * @param num_cpus Number of CPUs
+ */
+void cpu_account_tick(pcb_t **cpus, int num_cpus);
+
+/**
+ * @brief Save or restore the context switch and progress state of the CPUs
+ *
+ * @param ck The checkpoint
+ */
+void cpu_checkpoint(checkpoint_t *ck);
+
+#endif // CPU_H
@@ -0,0 +1,157 @@
+#include "easy.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "cpu.h"
+#include "debug.h"
+#include "gang.h"
+#include "msg.h"
+#include "stats.h"
+
+// CPUs que uma tarefa ocupa
+static int job_width(const pcb_t *p, int num_cpus) {
+    return (p->parallelism < (uint32_t)num_cpus) ? (int)p->parallelism : num_cpus;
+}
+
+// Tenta pôr a tarefa a correr agora; devolve 1 se começou
+static int try_start(pcb_t *p, pcb_t **cpus, int num_cpus, uint32_t current_time_ms) {
+    int n = job_width(p, num_cpus);
+    int cpu_list[MAX_CPUS];
+    if (n > 1) {
+        if (gang_select_cpus(cpus, num_cpus, n, cpu_list) < n) return 0;
+        cpu_dispatch_gang(p, cpus, cpu_list, n, current_time_ms);
+        STAT_ADD(gang_dispatches, 1);
+        for (int j = 1; j < n; j++) {
+            if (topo_socket(cpu_list[j]) != topo_socket(cpu_list[0])) {
+                STAT_ADD(gang_split_dispatches, 1);
+                break;
+            }
+        }
+    } else {
+        cpu_list[0] = cpu_select(p, cpus, num_cpus);
+        if (cpu_list[0] < 0) return 0;
+        cpu_dispatch(p, cpus, cpu_list[0], current_time_ms);
+    }
+    DBG("Process %d started on %d CPUs from CPU %d (EASY)\n", p->pid, n, cpu_list[0]);
+    return 1;
+}
+
+typedef struct {
+    uint32_t end_ms;    // Fim previsto, pelo tempo declarado
+    int width;          // CPUs que liberta
+} release_t;
+
+static int compare_release(const void *a, const void *b) {
+    const release_t *x = a, *y = b;
+    return (x->end_ms > y->end_ms) - (x->end_ms < y->end_ms);
+}
+
+void easy_reserve(int width, pcb_t **cpus, int num_cpus, uint32_t current_time_ms,
+                  uint32_t *shadow_ms, int *extra) {
+    release_t releases[MAX_CPUS];
+    int num_releases = 0;
+    int free_cpus = 0;
+    for (int i = 0; i < num_cpus; i++) {
+        pcb_t *p = cpus[i];
+        if (p == NULL) {
+            free_cpus++;
+        } else if (p->last_cpu == i) {  // Cada tarefa é contada na sua primeira CPU
+            releases[num_releases++] = (release_t){
+                .end_ms = current_time_ms + cpu_remaining_ms(p),
+                .width = job_width(p, num_cpus),
+            };
+        }
+    }
+    qsort(releases, (size_t)num_releases, sizeof(release_t), compare_release);
+
+    *shadow_ms = UINT32_MAX;
+    *extra = 0;
+    for (int r = 0; r < num_releases; r++) {
+        free_cpus += releases[r].width;
+        if (free_cpus >= width) {
+            *shadow_ms = releases[r].end_ms;
+            *extra = free_cpus - width;
+            return;
+        }
+    }
+}
+
+void easy_scheduler(uint32_t current_time_ms,
+                    queue_t *ready_queue,
+                    pcb_t **cpus,
+                    int num_cpus) {
+    uint32_t progress_ms[MAX_CPUS];
+    int i, j;
+
+    // 1. Avança todas as CPUs; uma tarefa paralela avança ao ritmo da sua CPU mais lenta
+    for (i = 0; i < num_cpus; i++) {
+        progress_ms[i] = (cpus[i] != NULL) ? cpu_run_tick(cpus, i) : 0;
+    }
+    for (i = 0; i < num_cpus; i++) {
+        pcb_t *p = cpus[i];
+        if (p == NULL || p->last_cpu != i) continue;
+
+        uint32_t step = progress_ms[i];
+        for (j = 0; j < num_cpus; j++) {
+            if (cpus[j] == p && progress_ms[j] < step) step = progress_ms[j];
+        }
+        p->ellapsed_time_ms += step;
+
+        if (p->ellapsed_time_ms >= p->time_ms) {
+            DBG("Process %d finished CPU burst on %d CPUs (EASY)\n", p->pid, job_width(p, num_cpus));
+            for (j = 0; j < num_cpus; j++) {
+                if (j != i && cpus[j] == p) cpus[j] = NULL;
+            }
+            cpu_burst_done(cpus, i, current_time_ms);
+        }
+    }
+
+    // 2. Por ordem de chegada, enquanto as tarefas cabem nas CPUs livres
+    queue_elem_t *elem = ready_queue->head;
+    int blocked = 0;            // A primeira tarefa da fila não cabe e tem uma reserva
+    uint32_t shadow_ms = 0;
+    int extra = 0;
+    while (elem != NULL && cpu_first_free(cpus, num_cpus) >= 0) {
+        pcb_t *next = elem->pcb;
+        int width = job_width(next, num_cpus);
+
+        if (blocked) {
+            // 3. Backfilling: só se não atrasa a reserva da primeira tarefa
+            int ends_before = (current_time_ms + cpu_remaining_ms(next) <= shadow_ms);
+            if (!ends_before && width > extra) {
+                elem = elem->next;
+                continue;
+            }
+            if (!try_start(next, cpus, num_cpus, current_time_ms)) {
+                elem = elem->next;
+                continue;
+            }
+            if (!ends_before) extra -= width;
+            STAT_ADD(backfills, 1);
+        } else if (!try_start(next, cpus, num_cpus, current_time_ms)) {
+            // Uma tarefa de uma só CPU que espera pela sua CPU anterior não precisa de reserva
+            if (width > 1) {
+                easy_reserve(width, cpus, num_cpus, current_time_ms, &shadow_ms, &extra);
+                blocked = 1;
+                DBG("Process %d reserved %d CPUs at %u ms (EASY)\n", next->pid, width, shadow_ms);
+            }
+            elem = elem->next;
+            continue;
+        }
+
+        queue_elem_t *tmp = elem;
+        elem = elem->next;
+        remove_queue_elem(ready_queue, tmp);
+        free(tmp);
+    }
+
+    // 4. CPUs livres que não puderam ser usadas pelas tarefas à espera
+    int idle = 0;
+    for (i = 0; i < num_cpus; i++) {
+        if (cpus[i] == NULL) idle++;
+    }
+    if (idle > 0 && ready_queue->head != NULL) {
+        STAT_ADD(wasted_cpu_ms, (uint64_t)idle * TICKS_MS);
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef EASY_H
+#define EASY_H
+
+#include "queue.h"
+#include <stdint.h>
+
+/**
+ * @brief Scheduler batch com EASY backfilling
+ *
+ * As tarefas são servidas por ordem de chegada e correm sem preempção até ao fim
+ * do burst; uma tarefa que pede N CPUs (parallelism) corre em N CPUs ao mesmo tempo.
+ * Quando a primeira tarefa da fila não cabe nas CPUs livres, recebe uma reserva:
+ * com os tempos declarados das tarefas em execução calcula-se o instante em que
+ * haverá CPUs livres suficientes para ela (shadow time). As tarefas seguintes só
+ * podem passar à frente (backfilling) se cabem nas CPUs livres e acabam antes desse
+ * instante, ou se usam apenas CPUs que sobram depois da reserva, pelo que nunca
+ * atrasam a primeira tarefa.
+ *
+ * @param current_time_ms Tempo atual da simulação em ms
+ * @param ready_queue     Fila de processos prontos
+ * @param cpus            Array de ponteiros para os processos em execução (um por CPU)
+ * @param num_cpus        Número de CPUs disponíveis
+ */
+void easy_scheduler(uint32_t current_time_ms,
+                    queue_t *ready_queue,
+                    pcb_t **cpus,
+                    int num_cpus);
+
+/**
+ * @brief Calcula a reserva de uma tarefa que não cabe nas CPUs livres
+ *
+ * Com os tempos declarados das tarefas em execução, calcula o instante em que haverá
+ * width CPUs livres (shadow time) e quantas CPUs sobram nesse instante para tarefas
+ * que acabam depois dele.
+ *
+ * @param width           Número de CPUs de que a tarefa precisa
+ * @param cpus            Array de ponteiros para os processos em execução (um por CPU)
+ * @param num_cpus        Número de CPUs disponíveis
+ * @param current_time_ms Tempo atual da simulação em ms
+ * @param shadow_ms       Onde é guardado o shadow time (UINT32_MAX se a tarefa nunca cabe)
+ * @param extra           Onde é guardado o número de CPUs que sobram nesse instante
+ */
+void easy_reserve(int width, pcb_t **cpus, int num_cpus, uint32_t current_time_ms,
+                  uint32_t *shadow_ms, int *extra);
+
+#endif // EASY_H
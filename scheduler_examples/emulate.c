@@ -0,0 +1,351 @@
+// CPU_SET and friends
+#define _GNU_SOURCE
+
+#include "emulate.h"
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "debug.h"
+#include "params.h"
+
+#define EMU_PAGE_SIZE 4096
+#define EMU_CACHE_LINE 64
+// Minimum duration of the calibration
+#define EMU_CALIBRATION_NS 50000000ull
+
+// Working set of a thread of a task, walked one cache line at a time. A parallel
+// task runs on several CPUs in the same tick, and each of its CPUs walks the
+// working set of another thread, so no two workers share a buffer.
+typedef struct emu_task {
+    int32_t pid;
+    uint8_t *buf;
+    size_t pos;
+    uint64_t tick;              // Generation of the tick where a worker got this thread
+    struct emu_task *next;      // Next thread of the same task
+} emu_task_t;
+
+typedef struct {
+    pthread_t thread;
+    int cpu;                    // Simulated CPU
+    int host_cpu;               // Host core where the worker is pinned
+    // Work of the current tick, set by the scheduling thread before emulate_tick()
+    emu_task_t *task;
+    uint32_t progress_ms;
+    // Results, index 0 for warm ticks (same working set as the previous tick), 1 for cold ones
+    const emu_task_t *last_task;
+    uint64_t ticks[2];
+    uint64_t modeled_ms[2];
+    uint64_t measured_ns[2];
+    uint64_t sink;              // Result of the kernel, so it is not optimized away
+} emu_worker_t;
+
+static emu_worker_t *workers = NULL;
+static int num_workers = 0;
+static uint64_t steps_per_ms = 0;
+static size_t working_set_len = 0;
+
+// Working sets by pid (open addressing, only used by the scheduling thread)
+static emu_task_t **tasks = NULL;
+static size_t tasks_capacity = 0;
+static size_t num_tasks = 0;
+
+static pthread_mutex_t emu_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t start_cond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t done_cond = PTHREAD_COND_INITIALIZER;
+static uint64_t generation = 0;     // Incremented by emulate_tick()
+static int pending = 0;             // Workers that did not finish the current tick
+static int stopping = 0;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+// The kernel: each step mixes a value and updates one cache line of the working set
+static uint64_t run_kernel(emu_task_t *task, uint64_t steps, uint64_t x) {
+    uint8_t *buf = task->buf;
+    size_t pos = task->pos;
+    for (uint64_t i = 0; i < steps; i++) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        if (working_set_len > 0) {
+            buf[pos] += (uint8_t)x;
+            pos += EMU_CACHE_LINE;
+            if (pos >= working_set_len) pos = 0;
+        }
+    }
+    task->pos = pos;
+    return x;
+}
+
+static emu_task_t *new_task(int32_t pid) {
+    emu_task_t *task = calloc(1, sizeof(emu_task_t));
+    if (task == NULL) return NULL;
+    task->pid = pid;
+    if (working_set_len > 0) {
+        task->buf = malloc(working_set_len);
+        if (task->buf == NULL) {
+            free(task);
+            return NULL;
+        }
+        memset(task->buf, (int)(pid & 0xff), working_set_len);
+    }
+    return task;
+}
+
+static int tasks_grow(void) {
+    size_t capacity = tasks_capacity ? tasks_capacity * 2 : 256;
+    emu_task_t **table = calloc(capacity, sizeof(emu_task_t *));
+    if (table == NULL) return -1;
+    for (size_t i = 0; i < tasks_capacity; i++) {
+        if (tasks[i] == NULL) continue;
+        size_t h = (uint32_t)tasks[i]->pid % capacity;
+        while (table[h] != NULL) h = (h + 1) % capacity;
+        table[h] = tasks[i];
+    }
+    free(tasks);
+    tasks = table;
+    tasks_capacity = capacity;
+    return 0;
+}
+
+// Find or create the working set of the first thread of a task
+static emu_task_t *find_task(int32_t pid) {
+    if (2 * (num_tasks + 1) > tasks_capacity && tasks_grow() != 0) return NULL;
+    size_t h = (uint32_t)pid % tasks_capacity;
+    while (tasks[h] != NULL) {
+        if (tasks[h]->pid == pid) return tasks[h];
+        h = (h + 1) % tasks_capacity;
+    }
+    tasks[h] = new_task(pid);
+    if (tasks[h] != NULL) num_tasks++;
+    return tasks[h];
+}
+
+static void *worker_main(void *arg) {
+    emu_worker_t *w = arg;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(w->host_cpu, &set);
+    if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+        perror("sched_setaffinity");
+    }
+
+    uint64_t seen = 0;
+    pthread_mutex_lock(&emu_lock);
+    while (1) {
+        while (generation == seen && !stopping) pthread_cond_wait(&start_cond, &emu_lock);
+        if (stopping) break;
+        seen = generation;
+        pthread_mutex_unlock(&emu_lock);
+
+        if (w->task != NULL) {
+            uint64_t start = now_ns();
+            w->sink = run_kernel(w->task, (uint64_t)w->progress_ms * steps_per_ms, w->sink);
+            uint64_t elapsed = now_ns() - start;
+            int cold = (w->task != w->last_task);
+            w->ticks[cold]++;
+            w->modeled_ms[cold] += w->progress_ms;
+            w->measured_ns[cold] += elapsed;
+            w->last_task = w->task;
+            w->task = NULL;
+        }
+
+        pthread_mutex_lock(&emu_lock);
+        if (--pending == 0) pthread_cond_signal(&done_cond);
+    }
+    pthread_mutex_unlock(&emu_lock);
+    return NULL;
+}
+
+// Steps of the kernel per millisecond, with a warm working set on this thread
+static uint64_t calibrate(void) {
+    emu_task_t *task = new_task(0);
+    if (task == NULL) return 0;
+    uint64_t x = 88172645463325252ull;
+    x = run_kernel(task, working_set_len / EMU_CACHE_LINE + 1, x);   // Warm up
+    uint64_t steps = 1000, elapsed = 0;
+    while (1) {
+        uint64_t start = now_ns();
+        x = run_kernel(task, steps, x);
+        elapsed = now_ns() - start;
+        if (elapsed >= EMU_CALIBRATION_NS) break;
+        steps *= 2;
+    }
+    free(task->buf);
+    free(task);
+    uint64_t per_ms = steps * 1000000u / elapsed + (x & 1);     // Use x
+    return per_ms ? per_ms : 1;
+}
+
+int emulate_start(int num_cpus) {
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        perror("sched_getaffinity");
+        return -1;
+    }
+    int host_cpus[CPU_SETSIZE];
+    int num_host_cpus = 0;
+    for (int c = 0; c < CPU_SETSIZE; c++) {
+        if (CPU_ISSET(c, &allowed)) host_cpus[num_host_cpus++] = c;
+    }
+    if (num_host_cpus < num_cpus) {
+        fprintf(stderr, "Warning: %d simulated CPUs on %d host cores, the workers will share cores\n",
+                num_cpus, num_host_cpus);
+    }
+
+    working_set_len = (size_t)sim_params.emulate_pages * EMU_PAGE_SIZE;
+    steps_per_ms = calibrate();
+    if (steps_per_ms == 0) return -1;
+
+    workers = calloc((size_t)num_cpus, sizeof(emu_worker_t));
+    if (workers == NULL) {
+        perror("calloc");
+        return -1;
+    }
+    for (int i = 0; i < num_cpus; i++) {
+        workers[i].cpu = i;
+        workers[i].host_cpu = host_cpus[i % num_host_cpus];
+        int err = pthread_create(&workers[i].thread, NULL, worker_main, &workers[i]);
+        if (err != 0) {
+            fprintf(stderr, "pthread_create: failed to start an emulation worker (%d)\n", err);
+            emulate_stop();
+            return -1;
+        }
+        num_workers++;
+    }
+    printf("Emulating %d CPUs on the host, %" PRIu64 " kernel steps per ms, working set %zu KB\n",
+           num_cpus, steps_per_ms, working_set_len / 1024);
+    return 0;
+}
+
+int emulate_active(void) {
+    return num_workers > 0;
+}
+
+void emulate_run(int cpu, int32_t pid, uint32_t progress_ms) {
+    if (cpu >= num_workers || progress_ms == 0) return;
+    // The first thread not given to another worker in this tick
+    uint64_t tick = generation + 1;
+    emu_task_t *task = find_task(pid);
+    while (task != NULL && task->tick == tick) {
+        if (task->next == NULL) task->next = new_task(pid);
+        task = task->next;
+    }
+    if (task != NULL) task->tick = tick;
+    workers[cpu].task = task;
+    workers[cpu].progress_ms = progress_ms;
+}
+
+void emulate_forget(int32_t pid) {
+    if (tasks_capacity == 0) return;
+    size_t h = (uint32_t)pid % tasks_capacity;
+    while (tasks[h] != NULL && tasks[h]->pid != pid) h = (h + 1) % tasks_capacity;
+    if (tasks[h] == NULL) return;
+
+    emu_task_t *task = tasks[h];
+    while (task != NULL) {
+        emu_task_t *next = task->next;
+        // A new working set at the same address must not look warm to the worker that ran this one
+        for (int i = 0; i < num_workers; i++) {
+            if (workers[i].last_task == task) workers[i].last_task = NULL;
+        }
+        free(task->buf);
+        free(task);
+        task = next;
+    }
+    num_tasks--;
+
+    // Close the gap in the probe sequence: move back the entries that can no longer be reached
+    tasks[h] = NULL;
+    for (size_t j = (h + 1) % tasks_capacity; tasks[j] != NULL; j = (j + 1) % tasks_capacity) {
+        size_t home = (uint32_t)tasks[j]->pid % tasks_capacity;
+        int reachable = (h < j) ? (h < home && home <= j) : (h < home || home <= j);
+        if (reachable) continue;
+        tasks[h] = tasks[j];
+        tasks[j] = NULL;
+        h = j;
+    }
+}
+
+void emulate_tick(void) {
+    if (num_workers == 0) return;
+    pthread_mutex_lock(&emu_lock);
+    pending = num_workers;
+    generation++;
+    pthread_cond_broadcast(&start_cond);
+    pthread_mutex_unlock(&emu_lock);
+}
+
+void emulate_wait(void) {
+    if (num_workers == 0) return;
+    pthread_mutex_lock(&emu_lock);
+    while (pending > 0) pthread_cond_wait(&done_cond, &emu_lock);
+    pthread_mutex_unlock(&emu_lock);
+}
+
+void emulate_stop(void) {
+    if (workers == NULL) return;
+    emulate_wait();
+    pthread_mutex_lock(&emu_lock);
+    stopping = 1;
+    pthread_cond_broadcast(&start_cond);
+    pthread_mutex_unlock(&emu_lock);
+    for (int i = 0; i < num_workers; i++) {
+        pthread_join(workers[i].thread, NULL);
+    }
+    for (size_t i = 0; i < tasks_capacity; i++) {
+        emu_task_t *task = tasks[i];
+        while (task != NULL) {
+            emu_task_t *next = task->next;
+            free(task->buf);
+            free(task);
+            task = next;
+        }
+    }
+    free(tasks);
+    tasks = NULL;
+    tasks_capacity = num_tasks = 0;
+    free(workers);
+    workers = NULL;
+    num_workers = 0;
+}
+
+// Measured time in percent of the modeled time
+static double slowdown_pct(uint64_t measured_ns, uint64_t modeled_ms) {
+    return modeled_ms ? 100.0 * (double)measured_ns / 1e6 / (double)modeled_ms : 0.0;
+}
+
+void emulate_print_stats(FILE *out) {
+    if (workers == NULL) return;
+    emulate_wait();
+    fprintf(out, "Emulation (measured time in %% of the modeled time, warm = same working set as the previous tick):\n");
+    uint64_t modeled[2] = {0}, measured[2] = {0};
+    for (int i = 0; i < num_workers; i++) {
+        const emu_worker_t *w = &workers[i];
+        uint64_t w_modeled = w->modeled_ms[0] + w->modeled_ms[1];
+        uint64_t w_measured = w->measured_ns[0] + w->measured_ns[1];
+        for (int k = 0; k < 2; k++) {
+            modeled[k] += w->modeled_ms[k];
+            measured[k] += w->measured_ns[k];
+        }
+        if (w_modeled == 0) continue;
+        fprintf(out, "  CPU %d (host core %d): modeled %" PRIu64 " ms, measured %.1f ms (%.1f%%), "
+                "warm %.1f%%, cold %.1f%% (%" PRIu64 " of %" PRIu64 " ticks)\n",
+                w->cpu, w->host_cpu, w_modeled, (double)w_measured / 1e6,
+                slowdown_pct(w_measured, w_modeled),
+                slowdown_pct(w->measured_ns[0], w->modeled_ms[0]),
+                slowdown_pct(w->measured_ns[1], w->modeled_ms[1]), w->ticks[1], w->ticks[0] + w->ticks[1]);
+    }
+    fprintf(out, "  Total: modeled %" PRIu64 " ms, measured %.1f ms (%.1f%%), warm %.1f%%, cold %.1f%%\n",
+            modeled[0] + modeled[1], (double)(measured[0] + measured[1]) / 1e6,
+            slowdown_pct(measured[0] + measured[1], modeled[0] + modeled[1]),
+            slowdown_pct(measured[0], modeled[0]), slowdown_pct(measured[1], modeled[1]));
+}
@@ -0,0 +1,85 @@
+#ifndef EMULATE_H
+#define EMULATE_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+ * Hybrid emulation: the simulated CPU time is also executed as real work on the
+ * host, to compare the predictions of the model with real hardware.
+ * Each simulated CPU has a worker thread pinned with sched_setaffinity to a host
+ * core (CPU i runs on the i-th core the simulator may use, wrapping around when
+ * there are fewer host cores). When a task makes progress on a CPU in a tick, the
+ * worker of that CPU runs a calibrated kernel for the same amount of CPU time
+ * and measures how long it really took. The kernel walks a working set of
+ * emulate_pages pages that belongs to the task (one per thread for a parallel
+ * task, so the CPUs of a gang never share one), so it follows the task when it
+ * moves to another CPU and is cold in the caches of the new core, and it competes
+ * with the tasks of the other workers for the shared caches and memory. With
+ * emulate_pages=0 it is a pure busy loop.
+ *
+ * The measurements do not change the simulation: the results are the same with
+ * and without emulation, and the measured times are reported at exit next to
+ * the modeled ones. Each tick takes at least as long as its longest real work.
+ */
+
+/**
+ * @brief Calibrate the kernel and start one pinned worker per simulated CPU
+ *
+ * @param num_cpus Number of simulated CPUs
+ * @return 0 on success, -1 on failure
+ */
+int emulate_start(int num_cpus);
+
+/**
+ * @brief Check if the emulation is running
+ */
+int emulate_active(void);
+
+/**
+ * @brief Give a worker the progress of a task in the current tick
+ *
+ * The work starts with emulate_tick().
+ *
+ * @param cpu         The simulated CPU
+ * @param pid         The task
+ * @param progress_ms The CPU time the model gave the task in this tick
+ */
+void emulate_run(int cpu, int32_t pid, uint32_t progress_ms);
+
+/**
+ * @brief Release the working sets of a task that left the simulator
+ *
+ * Must be called between ticks (after emulate_wait()), like the other changes
+ * to the tasks.
+ *
+ * @param pid The task
+ */
+void emulate_forget(int32_t pid);
+
+/**
+ * @brief Start the work of the current tick on all workers
+ */
+void emulate_tick(void);
+
+/**
+ * @brief Wait until the workers have finished the work of the current tick
+ */
+void emulate_wait(void);
+
+/**
+ * @brief Stop the workers and release the working sets
+ */
+void emulate_stop(void);
+
+/**
+ * @brief Print the modeled and measured CPU time of each CPU (before emulate_stop())
+ *
+ * Ticks where the worker ran the same task as in its previous tick (warm caches)
+ * are shown separately from the ticks after a change of task (cold caches).
+ *
+ * @param out The stream where the statistics will be printed
+ */
+void emulate_print_stats(FILE *out);
+
+#endif // EMULATE_H
@@ -0,0 +1,106 @@
+#include "fair.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "cpu.h"
+#include "debug.h"
+#include "group.h"
+#include "msg.h"
+#include "params.h"
+#include "probes.h"
+#include "stats.h"
+
+// O tempo virtual de um grupo avança VTIME_SCALE / peso por cada ms de progresso
+#define VTIME_SCALE 1000
+
+// Prioridade de um grupo: tempo virtual, mais um quantum por cada CPU que já ocupa,
+// para várias CPUs livres no mesmo tick não irem todas para o mesmo grupo
+static uint64_t group_key(const group_t *g, int running) {
+    return g->vtime + (uint64_t)running * sim_params.fair_quantum_ms * VTIME_SCALE / g->weight;
+}
+
+void fair_scheduler(uint32_t current_time_ms, queue_t *ready_queue, pcb_t **cpus, int num_cpus) {
+    int i;
+
+    // 1. Atualiza todos os processos que estão a correr nas CPUs
+    for (i = 0; i < num_cpus; i++) {
+        pcb_t *p = cpus[i];
+        if (p == NULL) continue;
+
+        uint32_t progress_ms = cpu_run_tick(cpus, i);
+        p->ellapsed_time_ms += progress_ms;
+        group_t *g = group_get(p->group);
+        g->vtime += (uint64_t)progress_ms * VTIME_SCALE / g->weight;
+
+        // Terminou o burst?
+        if (p->ellapsed_time_ms >= p->time_ms) {
+            DBG("Process %d finished CPU burst on CPU %d (FAIR)\n", p->pid, i);
+            cpu_burst_done(cpus, i, current_time_ms);
+            continue;
+        }
+
+        // Preempção por quantum: o grupo com menor tempo virtual escolhe a seguir
+        if (p->ellapsed_time_ms >= sim_params.fair_quantum_ms) {
+            DBG("Process %d preempted on CPU %d (quantum expired, FAIR)\n", p->pid, i);
+            PROBE4(preempt_quantum, p->pid, i, 0, current_time_ms);
+
+            p->time_ms -= p->ellapsed_time_ms;
+            p->ellapsed_time_ms = 0;
+            p->status = TASK_RUNNING;
+            enqueue_pcb(ready_queue, p);
+            cpus[i] = NULL;
+            STAT_ADD(preemptions, 1);
+        }
+    }
+
+    // 2. Grupos com tarefas a correr ou prontas
+    int num_groups = group_count();
+    int running[MAX_GROUPS] = {0};
+    int ready[MAX_GROUPS] = {0};
+    for (i = 0; i < num_cpus; i++) {
+        if (cpus[i] != NULL) running[cpus[i]->group]++;
+    }
+    for (queue_elem_t *elem = ready_queue->head; elem != NULL; elem = elem->next) {
+        ready[elem->pcb->group] = 1;
+    }
+    // Um grupo que volta a ter trabalho não pode usar o tempo em que esteve parado
+    // para ficar com as CPUs: começa no menor tempo virtual dos grupos já ativos
+    uint64_t min_vtime = UINT64_MAX;
+    for (int g = 0; g < num_groups; g++) {
+        group_t *grp = group_get(g);
+        if (grp->active && (running[g] || ready[g]) && grp->vtime < min_vtime) min_vtime = grp->vtime;
+    }
+    for (int g = 0; g < num_groups; g++) {
+        group_t *grp = group_get(g);
+        int active = running[g] || ready[g];
+        if (active && !grp->active && min_vtime != UINT64_MAX && grp->vtime < min_vtime) {
+            grp->vtime = min_vtime;
+        }
+        grp->active = active;
+    }
+
+    // 3. Coloca nas CPUs livres a primeira tarefa pronta do grupo com menor prioridade
+    while (cpu_first_free(cpus, num_cpus) >= 0) {
+        queue_elem_t *best = NULL;
+        uint64_t best_key = 0;
+        for (queue_elem_t *elem = ready_queue->head; elem != NULL; elem = elem->next) {
+            int g = elem->pcb->group;
+            uint64_t key = group_key(group_get(g), running[g]);
+            if ((best == NULL || key < best_key) && cpu_select(elem->pcb, cpus, num_cpus) >= 0) {
+                best = elem;
+                best_key = key;
+            }
+        }
+        if (best == NULL) break;   // Nada para executar (ou à espera da CPU anterior)
+
+        pcb_t *next = best->pcb;
+        int cpu = cpu_select(next, cpus, num_cpus);
+        remove_queue_elem(ready_queue, best);
+        free(best);
+        cpu_dispatch(next, cpus, cpu, current_time_ms);
+        running[next->group]++;
+
+        DBG("Process %d started on CPU %d (FAIR, group %s)\n", next->pid, cpu, group_get(next->group)->name);
+    }
+}
@@ -0,0 +1,25 @@
+#ifndef FAIR_H
+#define FAIR_H
+
+#include <stdint.h>
+#include "queue.h"
+
+/**
+ * @brief Escalonador fair-share hierárquico com suporte a múltiplos CPUs
+ *
+ * O tempo de CPU é dividido entre os grupos de aplicações (ver group.h) na
+ * proporção dos seus pesos, e dentro de cada grupo as tarefas são escalonadas
+ * em Round-Robin com quantum fair_quantum_ms. Um grupo com muitas tarefas não
+ * recebe mais CPU do que o seu peso permite, por isso não consegue atrasar os outros.
+ *
+ * @param current_time_ms Tempo atual da simulação em ms
+ * @param ready_queue     Fila de processos prontos
+ * @param cpus            Array de ponteiros para os processos em execução (um por CPU)
+ * @param num_cpus        Número de CPUs disponíveis
+ */
+void fair_scheduler(uint32_t current_time_ms,
+                    queue_t *ready_queue,
+                    pcb_t **cpus,
+                    int num_cpus);
+
+#endif // FAIR_H
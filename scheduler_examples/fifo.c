@@ -6,6 +6,7 @@
 #include "msg.h"
 #include <unistd.h>
 
+#include "cpu.h"
 #include "debug.h"
 
 void fifo_scheduler(uint32_t current_time_ms,
@@ -19,35 +20,33 @@ void fifo_scheduler(uint32_t current_time_ms,
         pcb_t *p = cpus[i];
         if (p == NULL) continue;
 
-        p->ellapsed_time_ms += TICKS_MS;
+        p->ellapsed_time_ms += cpu_run_tick(cpus, i);
 
         // Terminou o burst?
         if (p->ellapsed_time_ms >= p->time_ms) {
             DBG("Process %d finished CPU burst on CPU %d\n", p->pid, i);
-
-            msg_t done_msg = {
-                .pid = p->pid,
-                .request = PROCESS_REQUEST_DONE,
-                .time_ms = current_time_ms
-            };
-            write(p->sockfd, &done_msg, sizeof(msg_t));
-
-            p->status = TASK_COMMAND;
-            p->ellapsed_time_ms = 0;
-            cpus[i] = NULL;
+            cpu_burst_done(cpus, i, current_time_ms);
         }
     }
 
     // 2. Coloca processos da ready_queue nas CPUs livres (FIFO)
-    for (i = 0; i < num_cpus; i++) {
-        if (cpus[i] != NULL) continue;           // CPU ocupada
-        if (ready_queue->head == NULL) break;    // Nada para correr
+    // Um processo cuja CPU anterior fica livre em breve espera por ela,
+    // e os seguintes podem usar as CPUs livres
+    queue_elem_t *elem = ready_queue->head;
+    while (elem != NULL && cpu_first_free(cpus, num_cpus) >= 0) {
+        pcb_t *next = elem->pcb;
+        int cpu = cpu_select(next, cpus, num_cpus);
+        if (cpu < 0) {
+            elem = elem->next;
+            continue;
+        }
 
-        pcb_t *next = dequeue_pcb(ready_queue);
-        next->status = TASK_RUNNING;
-        next->ellapsed_time_ms = 0;
-        cpus[i] = next;
+        queue_elem_t *tmp = elem;
+        elem = elem->next;
+        remove_queue_elem(ready_queue, tmp);
+        free(tmp);
+        cpu_dispatch(next, cpus, cpu, current_time_ms);
 
-        DBG("Process %d started on CPU %d (FIFO)\n", next->pid, i);
+        DBG("Process %d started on CPU %d (FIFO)\n", next->pid, cpu);
     }
 }
\ No newline at end of file
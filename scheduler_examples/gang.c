@@ -0,0 +1,160 @@
+#include "gang.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "cpu.h"
+#include "debug.h"
+#include "easy.h"
+#include "msg.h"
+#include "stats.h"
+
+int gang_select_cpus(pcb_t **cpus, int num_cpus, int n, int *cpu_list) {
+    int num_sockets = topo_num_sockets();
+    int free_in_socket[MAX_CPUS] = {0};
+    int free_cpus = 0;
+    for (int i = 0; i < num_cpus; i++) {
+        if (cpus[i] == NULL) {
+            free_in_socket[topo_socket(i)]++;
+            free_cpus++;
+        }
+    }
+    if (free_cpus < n) return 0;
+
+    int used[MAX_CPUS] = {0};
+    int count = 0;
+    while (count < n) {
+        int needed = n - count;
+        int socket = -1;
+        for (int s = 0; s < num_sockets; s++) {
+            if (free_in_socket[s] == 0) continue;
+            if (socket < 0) {
+                socket = s;
+            } else if (free_in_socket[s] >= needed) {
+                if (free_in_socket[socket] < needed || free_in_socket[s] < free_in_socket[socket]) socket = s;
+            } else if (free_in_socket[socket] < needed && free_in_socket[s] > free_in_socket[socket]) {
+                socket = s;
+            }
+        }
+        // Usa as CPUs livres do nó escolhido até chegar a n ou esgotar o nó
+        while (count < n && free_in_socket[socket] > 0) {
+            int best = -1;
+            int best_busy = 0;
+            for (int i = 0; i < num_cpus; i++) {
+                if (cpus[i] != NULL || used[i] || topo_socket(i) != socket) continue;
+                int busy = topo_busy_siblings(cpus, i);
+                if (best < 0 || busy < best_busy) {
+                    best = i;
+                    best_busy = busy;
+                }
+            }
+            used[best] = 1;
+            free_in_socket[socket]--;
+            cpu_list[count++] = best;
+        }
+    }
+    return count;
+}
+
+void gang_scheduler(uint32_t current_time_ms,
+                    queue_t *ready_queue,
+                    pcb_t **cpus,
+                    int num_cpus) {
+    uint32_t progress_ms[MAX_CPUS];
+    int i, j;
+
+    // 1. Avança todas as CPUs; uma tarefa paralela avança ao ritmo da sua CPU mais lenta
+    for (i = 0; i < num_cpus; i++) {
+        progress_ms[i] = (cpus[i] != NULL) ? cpu_run_tick(cpus, i) : 0;
+    }
+    for (i = 0; i < num_cpus; i++) {
+        pcb_t *p = cpus[i];
+        if (p == NULL || p->last_cpu != i) continue;   // Cada tarefa é tratada na sua primeira CPU
+
+        uint32_t step = progress_ms[i];
+        for (j = 0; j < num_cpus; j++) {
+            if (cpus[j] == p && progress_ms[j] < step) step = progress_ms[j];
+        }
+        p->ellapsed_time_ms += step;
+
+        // Terminou o burst? Liberta todas as CPUs da tarefa
+        if (p->ellapsed_time_ms >= p->time_ms) {
+            DBG("Process %d finished CPU burst on %u CPUs (GANG)\n", p->pid, p->parallelism);
+            for (j = 0; j < num_cpus; j++) {
+                if (j != i && cpus[j] == p) cpus[j] = NULL;
+            }
+            cpu_burst_done(cpus, i, current_time_ms);
+        }
+    }
+
+    // 2. Coloca as tarefas nas CPUs livres. As tarefas paralelas mantêm a ordem de
+    // chegada: se a primeira não cabe, as seguintes esperam e ela recebe uma reserva
+    // (shadow time, como no EASY). As tarefas de uma só CPU podem usar as CPUs livres
+    // (backfilling) se acabam antes da reserva ou usam uma CPU que sobra depois dela,
+    // para que um fluxo contínuo de tarefas curtas não atrase a tarefa paralela para sempre
+    int gang_blocked = 0;
+    int held_back = 0;
+    uint32_t shadow_ms = 0;
+    int extra = 0;
+    queue_elem_t *elem = ready_queue->head;
+    while (elem != NULL && cpu_first_free(cpus, num_cpus) >= 0) {
+        pcb_t *next = elem->pcb;
+        int n = (next->parallelism < (uint32_t)num_cpus) ? (int)next->parallelism : num_cpus;
+        int cpu_list[MAX_CPUS];
+
+        if (n > 1) {
+            if (gang_blocked || gang_select_cpus(cpus, num_cpus, n, cpu_list) < n) {
+                if (!gang_blocked) {
+                    easy_reserve(n, cpus, num_cpus, current_time_ms, &shadow_ms, &extra);
+                    DBG("Process %d reserved %d CPUs at %u ms (GANG)\n", next->pid, n, shadow_ms);
+                }
+                gang_blocked = 1;
+                elem = elem->next;
+                continue;
+            }
+        } else {
+            int ends_before = !gang_blocked || current_time_ms + cpu_remaining_ms(next) <= shadow_ms;
+            if (!ends_before && extra < 1) {
+                held_back = 1;
+                elem = elem->next;
+                continue;
+            }
+            cpu_list[0] = cpu_select(next, cpus, num_cpus);
+            if (cpu_list[0] < 0) {
+                elem = elem->next;
+                continue;
+            }
+            if (!ends_before) extra--;
+        }
+
+        queue_elem_t *tmp = elem;
+        elem = elem->next;
+        remove_queue_elem(ready_queue, tmp);
+        free(tmp);
+        if (n > 1) {
+            cpu_dispatch_gang(next, cpus, cpu_list, n, current_time_ms);
+            STAT_ADD(gang_dispatches, 1);
+            for (j = 1; j < n; j++) {
+                if (topo_socket(cpu_list[j]) != topo_socket(cpu_list[0])) {
+                    STAT_ADD(gang_split_dispatches, 1);
+                    break;
+                }
+            }
+            DBG("Process %d started on %d CPUs from CPU %d (GANG)\n", next->pid, n, cpu_list[0]);
+        } else {
+            cpu_dispatch(next, cpus, cpu_list[0], current_time_ms);
+            DBG("Process %d started on CPU %d (GANG)\n", next->pid, cpu_list[0]);
+        }
+    }
+
+    // 3. Fragmentação: CPUs livres que não puderam ser usadas pelas tarefas à espera
+    int idle = 0;
+    for (i = 0; i < num_cpus; i++) {
+        if (cpus[i] == NULL) idle++;
+    }
+    if (idle > 0 && ready_queue->head != NULL) {
+        STAT_ADD(wasted_cpu_ms, (uint64_t)idle * TICKS_MS);
+        if (gang_blocked) STAT_ADD(gang_blocked_ms, TICKS_MS);
+        if (held_back) STAT_ADD(gang_reserved_ms, TICKS_MS);
+    }
+}
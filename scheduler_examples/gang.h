@@ -0,0 +1,42 @@
+#ifndef GANG_H
+#define GANG_H
+
+#include "queue.h"
+#include <stdint.h>
+
+/**
+ * @brief Gang scheduler com suporte a tarefas paralelas
+ *
+ * Uma tarefa que pede N CPUs (parallelism) só começa quando tem N CPUs livres,
+ * e corre em todas ao mesmo tempo até ao fim do burst (sem preempção).
+ * As tarefas paralelas são servidas por ordem de chegada; enquanto a primeira
+ * não cabe nas CPUs livres, essas CPUs são preenchidas por tarefas de uma só CPU
+ * (backfilling), mas só pelas que não atrasam a reserva da primeira (ver
+ * easy_reserve()), pelo que um fluxo de tarefas curtas não a pode adiar sem fim.
+ *
+ * @param current_time_ms Tempo atual da simulação em ms
+ * @param ready_queue     Fila de processos prontos
+ * @param cpus            Array de ponteiros para os processos em execução (um por CPU)
+ * @param num_cpus        Número de CPUs disponíveis
+ */
+void gang_scheduler(uint32_t current_time_ms,
+                    queue_t *ready_queue,
+                    pcb_t **cpus,
+                    int num_cpus);
+
+/**
+ * @brief Escolhe n CPUs livres o mais próximas possível para uma tarefa paralela
+ *
+ * De preferência todas no mesmo nó (o nó com menos CPUs livres onde a tarefa cabe),
+ * senão a partir dos nós com mais CPUs livres; dentro de cada nó, primeiro as CPUs
+ * em cores sem irmãos SMT ocupados.
+ *
+ * @param cpus     Array de ponteiros para os processos em execução (um por CPU)
+ * @param num_cpus Número de CPUs disponíveis
+ * @param n        Número de CPUs pedidas
+ * @param cpu_list Onde são guardadas as CPUs escolhidas
+ * @return O número de CPUs escolhidas (0 se não houver CPUs livres suficientes)
+ */
+int gang_select_cpus(pcb_t **cpus, int num_cpus, int n, int *cpu_list);
+
+#endif // GANG_H
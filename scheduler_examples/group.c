@@ -0,0 +1,222 @@
+#include "group.h"
+
+#include <errno.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "stats.h"
+
+static group_t groups[MAX_GROUPS];
+static int num_groups = 0;
+
+// Weights given with -w, applied when the group is registered
+typedef struct {
+    char name[MSG_GROUP_LEN];
+    uint32_t weight;
+} group_weight_t;
+
+static group_weight_t weights[MAX_GROUPS];
+static int num_weights = 0;
+
+// Weight given with -w for a group, or 0 if there is none
+static uint32_t configured_weight(const char *name) {
+    for (int i = 0; i < num_weights; i++) {
+        if (strcmp(weights[i].name, name) == 0) return weights[i].weight;
+    }
+    return 0;
+}
+
+int group_set_weight(const char *assignment) {
+    const char *eq = strchr(assignment, '=');
+    if (eq == NULL || eq == assignment || eq - assignment >= MSG_GROUP_LEN) {
+        fprintf(stderr, "Invalid group weight %s, expected name=weight (name up to %d characters)\n",
+                assignment, MSG_GROUP_LEN - 1);
+        return -1;
+    }
+    char *endptr;
+    errno = 0;
+    long weight = strtol(eq + 1, &endptr, 10);
+    if (errno != 0 || *endptr != '\0' || endptr == eq + 1 || weight < 1 || weight > INT_MAX) {
+        fprintf(stderr, "Invalid weight for group %.*s: %s\n", (int)(eq - assignment), assignment, eq + 1);
+        return -1;
+    }
+    if (num_weights == MAX_GROUPS) {
+        fprintf(stderr, "Too many groups (max %d)\n", MAX_GROUPS);
+        return -1;
+    }
+    group_weight_t *w = &weights[num_weights++];
+    memset(w, 0, sizeof(*w));
+    memcpy(w->name, assignment, (size_t)(eq - assignment));
+    w->weight = (uint32_t)weight;
+    return 0;
+}
+
+static int32_t find_group(const char *name, size_t len) {
+    for (int i = 0; i < num_groups; i++) {
+        if (strlen(groups[i].name) == len && strncmp(groups[i].name, name, len) == 0) return i;
+    }
+    return -1;
+}
+
+// Start a new group in a slot, new or reused
+static int32_t register_group(int32_t index, const char *name, size_t len) {
+    group_t *g = &groups[index];
+    memset(g, 0, sizeof(*g));
+    memcpy(g->name, name, len);
+    uint32_t weight = configured_weight(g->name);
+    g->weight = weight ? weight : 1;
+    return index;
+}
+
+static int32_t group_lookup(const char *name) {
+    size_t len = strnlen(name, MSG_GROUP_LEN - 1);
+    if (len == 0) {
+        name = DEFAULT_GROUP;
+        len = strlen(DEFAULT_GROUP);
+    }
+    int32_t index = find_group(name, len);
+    if (index >= 0) return index;
+
+    // Keep a slot for the default group until it is registered
+    int32_t default_index = find_group(DEFAULT_GROUP, strlen(DEFAULT_GROUP));
+    int is_default = (len == strlen(DEFAULT_GROUP) && strncmp(name, DEFAULT_GROUP, len) == 0);
+    int limit = (is_default || default_index >= 0) ? MAX_GROUPS : MAX_GROUPS - 1;
+    if (num_groups < limit) return register_group(num_groups++, name, len);
+
+    // Reuse the slot of a group that has no tasks left (its accounting is dropped)
+    for (int32_t g = 0; g < num_groups; g++) {
+        if (groups[g].num_tasks == 0 && g != default_index) {
+            STAT_ADD(groups_recycled, 1);
+            return register_group(g, name, len);
+        }
+    }
+
+    // The task still runs, but in the default group, with its weight
+    static int warned = 0;
+    if (!warned) {
+        fprintf(stderr, "Too many groups with tasks (max %d): group %.*s and the next new groups are put in group %s\n",
+                MAX_GROUPS, (int)len, name, DEFAULT_GROUP);
+        warned = 1;
+    }
+    STAT_ADD(group_overflows, 1);
+    if (default_index < 0) default_index = register_group(num_groups++, DEFAULT_GROUP, strlen(DEFAULT_GROUP));
+    return default_index;
+}
+
+void group_join(pcb_t *p, const char *name) {
+    int32_t index = group_lookup(name);
+    if (index == p->group) return;
+    group_leave(p);
+    groups[index].num_tasks++;
+    p->group = index;
+}
+
+void group_leave(pcb_t *p) {
+    if (p->group < 0) return;
+    groups[p->group].num_tasks--;
+    p->group = -1;
+}
+
+group_t *group_get(int32_t index) {
+    return &groups[index];
+}
+
+int group_count(void) {
+    return num_groups;
+}
+
+// Divide the CPUs between the groups by weight, capped by the CPUs each group can use
+static void divide_cpus(const int *demand, int num_cpus, double *share) {
+    int saturated[MAX_GROUPS] = {0};
+    double left = num_cpus;
+    int changed = 1;
+    while (changed) {
+        changed = 0;
+        double weights = 0;
+        for (int g = 0; g < num_groups; g++) {
+            if (demand[g] > 0 && !saturated[g]) weights += groups[g].weight;
+        }
+        if (weights == 0) return;
+        for (int g = 0; g < num_groups; g++) {
+            if (demand[g] == 0 || saturated[g]) continue;
+            share[g] = left * groups[g].weight / weights;
+            if (demand[g] <= share[g]) {
+                // Needs less than its part, the rest is divided again between the others
+                share[g] = demand[g];
+                saturated[g] = 1;
+                left -= demand[g];
+                changed = 1;
+                break;
+            }
+        }
+    }
+}
+
+void group_account_tick(const queue_t *ready_queue, pcb_t **cpus, int num_cpus) {
+    if (num_groups == 0) return;
+    int demand[MAX_GROUPS] = {0};      // CPUs each group could use
+    int running[MAX_GROUPS] = {0};
+    for (int i = 0; i < num_cpus; i++) {
+        if (cpus[i] == NULL) continue;
+        running[cpus[i]->group]++;
+        demand[cpus[i]->group]++;
+    }
+    for (const queue_elem_t *elem = ready_queue->head; elem != NULL; elem = elem->next) {
+        demand[elem->pcb->group] += (int)elem->pcb->parallelism;
+    }
+    int competing = 0;
+    for (int g = 0; g < num_groups; g++) {
+        groups[g].cpu_ms += (uint64_t)running[g] * TICKS_MS;
+        if (demand[g] > 0) {
+            groups[g].demand_ms += TICKS_MS;
+            competing++;
+        }
+    }
+    if (competing < 2) return;
+
+    double share[MAX_GROUPS] = {0};
+    divide_cpus(demand, num_cpus, share);
+    for (int g = 0; g < num_groups; g++) {
+        if (demand[g] == 0) continue;
+        groups[g].competing_cpu_ms += (uint64_t)running[g] * TICKS_MS;
+        groups[g].entitled_ms += share[g] * TICKS_MS;
+    }
+}
+
+void group_print_stats(FILE *out) {
+    if (STAT_GET(groups_recycled) > 0) {
+        fprintf(out, "  Groups without tasks replaced by new groups: %" PRIu64 "\n", STAT_GET(groups_recycled));
+    }
+    if (STAT_GET(group_overflows) > 0) {
+        fprintf(out, "  Tasks over the limit of %d groups with tasks: %" PRIu64 " (put in group %s)\n",
+                MAX_GROUPS, STAT_GET(group_overflows), DEFAULT_GROUP);
+    }
+    for (int g = 0; g < num_groups; g++) {
+        const group_t *grp = &groups[g];
+        fprintf(out, "  Group %-12s weight %u: CPU %" PRIu64 " ms, demand %" PRIu64 " ms; while competing "
+                "%" PRIu64 " ms of %.0f ms entitled (%.1f%%)\n",
+                grp->name, grp->weight, grp->cpu_ms, grp->demand_ms, grp->competing_cpu_ms, grp->entitled_ms,
+                grp->entitled_ms > 0 ? 100.0 * (double)grp->competing_cpu_ms / grp->entitled_ms : 0.0);
+    }
+}
+
+void group_checkpoint(checkpoint_t *ck) {
+    uint32_t count = (uint32_t)num_groups;
+    ckpt_u32(ck, &count);
+    if (count > MAX_GROUPS) {
+        ckpt_fail(ck, "too many groups");
+        return;
+    }
+    for (uint32_t g = 0; g < count; g++) {
+        ckpt_bytes(ck, &groups[g], sizeof(group_t));
+        if (ckpt_restoring(ck)) {
+            // Weights given with -w take precedence, to compare weights from the same state
+            groups[g].name[MSG_GROUP_LEN - 1] = '\0';
+            uint32_t weight = configured_weight(groups[g].name);
+            if (weight) groups[g].weight = weight;
+        }
+    }
+    if (ckpt_restoring(ck)) num_groups = (int)count;
+}
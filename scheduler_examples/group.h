@@ -0,0 +1,103 @@
+#ifndef GROUP_H
+#define GROUP_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "checkpoint.h"
+#include "msg.h"
+
+/*
+ * Application groups (tenants).
+ * Each application sends its group with its requests (the OSSIM_GROUP environment
+ * variable, or the name of the application by default). The groups are registered
+ * the first time they are seen and identified by an index stored in the pcbs. A
+ * group without tasks left gives its slot to the next new group when the table is
+ * full; the last slot is kept for the default group, which takes the tasks of new
+ * groups while all the other slots are in use.
+ * Each group has a weight, set with -w name=weight (1 by default), that the FAIR
+ * scheduler uses to divide the CPU time, and the CPU time actually received by each
+ * group is accounted for every scheduler, to compare it with the weights.
+ */
+
+#define MAX_GROUPS 64
+#define DEFAULT_GROUP "default"
+
+typedef struct {
+    char name[MSG_GROUP_LEN];
+    uint32_t weight;
+    uint64_t cpu_ms;            // CPU time received (busy time of the CPUs running its tasks)
+    uint64_t demand_ms;         // Time the group had tasks running or waiting for a CPU
+    uint64_t competing_cpu_ms;  // CPU time received while other groups also had demand
+    double entitled_ms;         // CPU time its weight entitled it to in the same ticks
+    uint64_t vtime;             // Virtual time: progress of its tasks divided by the weight (FAIR)
+    int active;                 // Had tasks running or ready in the last tick (FAIR)
+    uint32_t num_tasks;         // Tasks in the group; the slot can be reused when it is 0
+} group_t;
+
+/**
+ * @brief Set the weight of a group from a "name=weight" assignment
+ *
+ * @param assignment The group and its weight (1 or more)
+ * @return 0 on success, -1 if the assignment is invalid
+ */
+int group_set_weight(const char *assignment);
+
+/**
+ * @brief Put a task in a group by name, registering the group if it is new
+ *
+ * The task leaves its previous group. When all the slots are in use by groups with
+ * tasks, the task goes to the default group; these tasks are counted in the
+ * statistics and the first one is reported on stderr.
+ *
+ * @param p    The task
+ * @param name The name of the group (an empty name is the default group)
+ */
+void group_join(pcb_t *p, const char *name);
+
+/**
+ * @brief Take a task out of its group when it leaves the simulator
+ *
+ * @param p The task
+ */
+void group_leave(pcb_t *p);
+
+/**
+ * @brief Get a group by index
+ */
+group_t *group_get(int32_t index);
+
+/**
+ * @brief Number of registered groups
+ */
+int group_count(void);
+
+/**
+ * @brief Account one tick of CPU time and demand for the groups
+ *
+ * @param ready_queue The tasks waiting for a CPU
+ * @param cpus        Array with the task running on each CPU (NULL if idle)
+ * @param num_cpus    Number of CPUs
+ */
+void group_account_tick(const queue_t *ready_queue, pcb_t **cpus, int num_cpus);
+
+/**
+ * @brief Print the CPU time of each group next to the time its weight entitled it to
+ *
+ * The entitlement is only accounted while several groups compete for the CPUs:
+ * in each tick, the CPUs are divided between the groups with demand in proportion
+ * to their weights, and a group that needs fewer CPUs than its part leaves the
+ * rest to the others (max-min fairness).
+ *
+ * @param out The stream where the statistics will be printed
+ */
+void group_print_stats(FILE *out);
+
+/**
+ * @brief Save or restore the groups and their accounting
+ *
+ * @param ck The checkpoint
+ */
+void group_checkpoint(checkpoint_t *ck);
+
+#endif // GROUP_H
@@ -0,0 +1,21 @@
+#include "hist.h"
+
+void hist_record(hist_t *h, uint64_t duration) {
+    int bucket = duration ? 63 - __builtin_clzll(duration) : 0;
+    if (bucket >= HIST_BUCKETS) bucket = HIST_BUCKETS - 1;
+    h->buckets[bucket]++;
+    if (h->count == 0 || duration < h->min_ns) h->min_ns = duration;
+    if (duration > h->max_ns) h->max_ns = duration;
+    h->total_ns += duration;
+    h->count++;
+}
+
+uint64_t hist_percentile(const hist_t *h, double fraction) {
+    uint64_t target = (uint64_t)((double)h->count * fraction);
+    uint64_t seen = 0;
+    for (int b = 0; b < HIST_BUCKETS - 1; b++) {
+        seen += h->buckets[b];
+        if (seen > target) return (2ull << b) - 1;
+    }
+    return h->max_ns;
+}
@@ -0,0 +1,39 @@
+#ifndef HIST_H
+#define HIST_H
+
+#include <stdint.h>
+
+/*
+ * Histogram of durations in nanoseconds with power of two buckets: bucket b holds
+ * the durations in [2^b, 2^(b+1)) ns, the last one everything above. Used by the
+ * phase timing of the simulator and by the client latency of the applications.
+ */
+
+#define HIST_BUCKETS 40
+
+typedef struct {
+    uint64_t count;
+    uint64_t total_ns;
+    uint64_t min_ns;
+    uint64_t max_ns;
+    uint64_t buckets[HIST_BUCKETS];
+} hist_t;
+
+/**
+ * @brief Record one duration
+ *
+ * @param h        The histogram
+ * @param duration The duration in nanoseconds
+ */
+void hist_record(hist_t *h, uint64_t duration);
+
+/**
+ * @brief Upper bound of the bucket where the given fraction of the samples is reached
+ *
+ * @param h        The histogram
+ * @param fraction The fraction of the samples, e.g. 0.99 for the 99th percentile
+ * @return The upper bound in nanoseconds, or the maximum if it is in the last bucket
+ */
+uint64_t hist_percentile(const hist_t *h, double fraction);
+
+#endif // HIST_H
@@ -0,0 +1,243 @@
+#include "hotplug.h"
+
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cpu.h"
+#include "debug.h"
+#include "msg.h"
+#include "power.h"
+#include "stats.h"
+#include "topology.h"
+
+#define HOTPLUG_UNSETTLED UINT32_MAX
+
+typedef struct {
+    uint32_t time_ms;
+    uint32_t num_cpus;
+} hotplug_step_t;
+
+// A change of the online CPUs and how long the scheduler took to absorb it
+typedef struct {
+    uint32_t time_ms;
+    uint32_t from_cpus;
+    uint32_t to_cpus;
+    uint32_t evicted;           // Tasks sent back to the ready queue
+    uint32_t settle_ms;         // HOTPLUG_UNSETTLED until absorbed
+} hotplug_event_t;
+
+static hotplug_step_t *schedule = NULL;
+static uint32_t schedule_len = 0;
+static uint32_t next_step = 0;
+static atomic_int requested = -1;   // From the metrics thread, -1 if none
+static uint32_t online = 0;         // 0 until the first change: all the CPUs
+
+static hotplug_event_t *events = NULL;
+static uint32_t num_events = 0;
+static uint32_t events_capacity = 0;
+
+// The change being absorbed, and its evicted tasks that did not leave the ready queue yet
+static int32_t pending_event = -1;
+static int32_t pending_pids[MAX_CPUS];
+static uint32_t num_pending_pids = 0;
+
+int hotplug_online_cpus(void) {
+    return online ? (int)online : topo_num_cpus();
+}
+
+int hotplug_load(const char *path) {
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        perror(path);
+        return -1;
+    }
+    char line[128];
+    int line_no = 0;
+    int ret = 0;
+    while (ret == 0 && fgets(line, sizeof(line), file)) {
+        line_no++;
+        char *p = line;
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p == '#' || *p == '\n' || *p == '\r' || *p == '\0') continue;
+
+        unsigned long time_ms;
+        int num_cpus;
+        char extra;
+        if (sscanf(p, "%lu %d %c", &time_ms, &num_cpus, &extra) != 2 || time_ms > UINT32_MAX ||
+            num_cpus < 1 || num_cpus > topo_num_cpus() ||
+            (schedule_len > 0 && time_ms < schedule[schedule_len - 1].time_ms)) {
+            fprintf(stderr, "%s:%d: expected \"time_ms cpus\" in order of time, with 1 to %d CPUs\n",
+                    path, line_no, topo_num_cpus());
+            ret = -1;
+            break;
+        }
+        hotplug_step_t *tmp = realloc(schedule, (schedule_len + 1) * sizeof(hotplug_step_t));
+        if (tmp == NULL) {
+            perror("realloc");
+            ret = -1;
+            break;
+        }
+        schedule = tmp;
+        schedule[schedule_len++] = (hotplug_step_t){.time_ms = (uint32_t)time_ms, .num_cpus = (uint32_t)num_cpus};
+    }
+    fclose(file);
+    return ret;
+}
+
+int hotplug_request(int num_cpus) {
+    if (num_cpus < 1 || num_cpus > topo_num_cpus()) return -1;
+    atomic_store(&requested, num_cpus);
+    return 0;
+}
+
+static int add_event(const hotplug_event_t *event) {
+    if (num_events == events_capacity) {
+        uint32_t capacity = events_capacity ? events_capacity * 2 : 16;
+        hotplug_event_t *tmp = realloc(events, capacity * sizeof(hotplug_event_t));
+        if (tmp == NULL) {
+            perror("realloc");
+            return -1;
+        }
+        events = tmp;
+        events_capacity = capacity;
+    }
+    events[num_events++] = *event;
+    return 0;
+}
+
+int hotplug_tick(uint32_t current_time_ms, pcb_t **cpus, int num_cpus, queue_t *ready_queue) {
+    int target = num_cpus;
+    while (next_step < schedule_len && schedule[next_step].time_ms <= current_time_ms) {
+        target = (int)schedule[next_step++].num_cpus;
+    }
+    int req = atomic_exchange(&requested, -1);
+    if (req > 0) target = req;
+    if (target == num_cpus) return num_cpus;
+
+    // Take the tasks off the CPUs going offline, with all the CPUs of a parallel task
+    pcb_t *evicted[MAX_CPUS];
+    int num_evicted = 0;
+    for (int i = target; i < num_cpus; i++) {
+        pcb_t *p = cpus[i];
+        if (p == NULL) continue;
+        for (int j = 0; j < num_cpus; j++) {
+            if (cpus[j] == p) cpus[j] = NULL;
+        }
+        DBG("Process %d evicted from CPU %d (CPU going offline)\n", p->pid, i);
+        p->time_ms -= p->ellapsed_time_ms;
+        p->ellapsed_time_ms = 0;
+        p->status = TASK_RUNNING;
+        evicted[num_evicted++] = p;
+    }
+    for (int i = target; i < num_cpus; i++) power_offline(i);
+    // They were running, so they go ahead of the tasks that were waiting
+    if (num_evicted > 0) {
+        queue_t waiting = *ready_queue;
+        ready_queue->head = ready_queue->tail = NULL;
+        ready_queue->size = 0;
+        for (int k = 0; k < num_evicted; k++) enqueue_pcb(ready_queue, evicted[k]);
+        pcb_t *p;
+        while ((p = dequeue_pcb(&waiting)) != NULL) enqueue_pcb(ready_queue, p);
+    }
+    STAT_ADD(hotplug_evictions, num_evicted);
+    printf("CPU hotplug at %u ms: %d -> %d CPUs online, %d tasks evicted\n",
+           current_time_ms, num_cpus, target, num_evicted);
+
+    hotplug_event_t event = {
+        .time_ms = current_time_ms,
+        .from_cpus = (uint32_t)num_cpus,
+        .to_cpus = (uint32_t)target,
+        .evicted = (uint32_t)num_evicted,
+        .settle_ms = HOTPLUG_UNSETTLED,
+    };
+    // A change that was not absorbed yet stays unsettled
+    pending_event = (add_event(&event) == 0) ? (int32_t)num_events - 1 : -1;
+    num_pending_pids = 0;
+    for (int k = 0; k < num_evicted; k++) pending_pids[num_pending_pids++] = evicted[k]->pid;
+    online = (uint32_t)target;
+    return target;
+}
+
+static int in_queue(const queue_t *q, int32_t pid) {
+    for (const queue_elem_t *elem = q->head; elem != NULL; elem = elem->next) {
+        if (elem->pcb->pid == pid) return 1;
+    }
+    return 0;
+}
+
+void hotplug_account_tick(uint32_t current_time_ms, pcb_t **cpus, int num_cpus, const queue_t *ready_queue) {
+    uint64_t capacity = 0;
+    for (int i = 0; i < num_cpus; i++) capacity += topo_capacity(i);
+    STAT_ADD(online_cpu_ms, (uint64_t)num_cpus * TICKS_MS);
+    STAT_SET(online_cpus, num_cpus);
+    STAT_SET(online_capacity_pct, capacity);
+
+    if (pending_event < 0) return;
+    uint32_t k = 0;
+    while (k < num_pending_pids) {
+        if (in_queue(ready_queue, pending_pids[k])) {
+            k++;
+        } else {
+            pending_pids[k] = pending_pids[--num_pending_pids];
+        }
+    }
+    int idle_while_waiting = (ready_queue->head != NULL && cpu_first_free(cpus, num_cpus) >= 0);
+    if (num_pending_pids == 0 && !idle_while_waiting) {
+        hotplug_event_t *event = &events[pending_event];
+        event->settle_ms = current_time_ms - event->time_ms;
+        pending_event = -1;
+    }
+}
+
+void hotplug_print_stats(FILE *out, uint32_t current_time_ms) {
+    if (num_events == 0 && schedule_len == 0) return;
+    fprintf(out, "CPU hotplug: %u changes, %d of %d CPUs online at the end, %" PRIu64 " ms of online CPU time "
+            "(average %.2f online CPUs)\n",
+            num_events, hotplug_online_cpus(), topo_num_cpus(), STAT_GET(online_cpu_ms),
+            current_time_ms ? (double)STAT_GET(online_cpu_ms) / (double)current_time_ms : 0.0);
+    for (uint32_t e = 0; e < num_events; e++) {
+        const hotplug_event_t *event = &events[e];
+        fprintf(out, "  At %u ms: %u -> %u CPUs, %u tasks evicted, ", event->time_ms, event->from_cpus,
+                event->to_cpus, event->evicted);
+        if (event->settle_ms != HOTPLUG_UNSETTLED) {
+            fprintf(out, "absorbed after %u ms\n", event->settle_ms);
+        } else if ((int32_t)e == pending_event) {
+            fprintf(out, "not absorbed at the end\n");
+        } else {
+            fprintf(out, "not absorbed before the next change\n");
+        }
+    }
+}
+
+void hotplug_checkpoint(checkpoint_t *ck) {
+    // The schedule is loaded again from -H; only the position in it is saved
+    ckpt_u32(ck, &online);
+    ckpt_u32(ck, &next_step);
+    uint32_t pending = (uint32_t)(pending_event + 1);
+    ckpt_u32(ck, &pending);
+    ckpt_u32(ck, &num_pending_pids);
+    if (num_pending_pids > MAX_CPUS || (int)online > topo_num_cpus()) {
+        ckpt_fail(ck, "invalid hotplug state");
+        return;
+    }
+    ckpt_bytes(ck, pending_pids, num_pending_pids * sizeof(int32_t));
+    uint32_t count = num_events;
+    ckpt_u32(ck, &count);
+    if (ckpt_restoring(ck)) {
+        pending_event = (int32_t)pending - 1;
+        if (next_step > schedule_len) next_step = schedule_len;
+        num_events = 0;
+        for (uint32_t e = 0; e < count; e++) {
+            hotplug_event_t event;
+            ckpt_bytes(ck, &event, sizeof(event));
+            if (add_event(&event) != 0) {
+                ckpt_fail(ck, "out of memory");
+                return;
+            }
+        }
+    } else {
+        ckpt_bytes(ck, events, count * sizeof(hotplug_event_t));
+    }
+}
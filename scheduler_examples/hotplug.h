@@ -0,0 +1,79 @@
+#ifndef HOTPLUG_H
+#define HOTPLUG_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "checkpoint.h"
+#include "queue.h"
+
+/*
+ * CPU hotplug: the number of online CPUs can change during a run, from a schedule
+ * file (-H) or with a "cpus N" command on the metrics socket. The online CPUs are
+ * always the first N CPUs of the topology, so the schedulers only see a smaller or
+ * bigger num_cpus: CPUs go offline from the highest number down and come back in
+ * order. The tasks running on a CPU that goes offline are sent back to the head of
+ * the ready queue, keeping the CPU time they received (a parallel task leaves all
+ * its CPUs), and an offline CPU neither runs tasks nor uses energy.
+ *
+ * For each change, the statistics report how long the scheduler took to absorb it:
+ * the time until no online CPU is idle while tasks wait and all the tasks evicted
+ * by the change have left the ready queue (0 if it happened in the same tick).
+ */
+
+/**
+ * @brief Load a hotplug schedule
+ *
+ * Each line of the file is "time_ms cpus": from time_ms on, cpus CPUs are online.
+ * Lines must be in order of time; empty lines and lines starting with # are ignored.
+ *
+ * @param path The schedule file
+ * @return 0 on success, -1 if the file cannot be read or is invalid
+ */
+int hotplug_load(const char *path);
+
+/**
+ * @brief Ask for a number of online CPUs, applied at the next tick (thread safe)
+ *
+ * @param num_cpus The number of CPUs, between 1 and the CPUs of the topology
+ * @return 0 on success, -1 if the number is out of range
+ */
+int hotplug_request(int num_cpus);
+
+/**
+ * @brief Apply the changes due at this tick, before the scheduler runs
+ *
+ * @param current_time_ms Current simulation time
+ * @param cpus            The CPUs (all the CPUs of the topology)
+ * @param num_cpus        CPUs online until now
+ * @param ready_queue     Where the tasks of the CPUs going offline are sent
+ * @return The number of CPUs online from now on
+ */
+int hotplug_tick(uint32_t current_time_ms, pcb_t **cpus, int num_cpus, queue_t *ready_queue);
+
+/**
+ * @brief Account the online capacity and follow the pending change, after the scheduler runs
+ */
+void hotplug_account_tick(uint32_t current_time_ms, pcb_t **cpus, int num_cpus, const queue_t *ready_queue);
+
+/**
+ * @brief Number of CPUs online (all the CPUs of the topology until a change)
+ */
+int hotplug_online_cpus(void);
+
+/**
+ * @brief Print the changes of capacity and the time each one took to be absorbed
+ *
+ * @param out             The stream where the statistics will be printed
+ * @param current_time_ms Current simulation time
+ */
+void hotplug_print_stats(FILE *out, uint32_t current_time_ms);
+
+/**
+ * @brief Save or restore the online CPUs, the position in the schedule and the changes
+ *
+ * @param ck The checkpoint
+ */
+void hotplug_checkpoint(checkpoint_t *ck);
+
+#endif // HOTPLUG_H
@@ -0,0 +1,206 @@
+#include "iodev.h"
+
+#include <errno.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "debug.h"
+#include "msg.h"
+
+static const char *IO_DISCIPLINE_NAMES[] = {
+    "FIFO",
+    "SHORTEST",
+    "ELEVATOR",
+    NULL
+};
+
+static io_device_t io_devices[MAX_IO_DEVICES];
+static int num_io_devices = 0;
+
+int io_add_device(const char *spec) {
+    if (num_io_devices >= MAX_IO_DEVICES) {
+        fprintf(stderr, "Too many I/O devices (max %d)\n", MAX_IO_DEVICES);
+        return -1;
+    }
+    const char *colon = strchr(spec, ':');
+    if (colon == NULL || colon == spec || (size_t)(colon - spec) >= IO_DEVICE_NAME_LEN) {
+        fprintf(stderr, "Invalid I/O device %s, expected name:channels[:discipline]\n", spec);
+        return -1;
+    }
+
+    char *endptr;
+    errno = 0;
+    long channels = strtol(colon + 1, &endptr, 10);
+    if (errno != 0 || endptr == colon + 1 || channels <= 0 || channels > INT_MAX ||
+        (*endptr != '\0' && *endptr != ':')) {
+        fprintf(stderr, "Invalid number of channels for I/O device %s\n", spec);
+        return -1;
+    }
+
+    io_discipline_en discipline = IO_SCHED_FIFO;
+    if (*endptr == ':') {
+        int i;
+        for (i = 0; IO_DISCIPLINE_NAMES[i] != NULL; i++) {
+            if (strcmp(endptr + 1, IO_DISCIPLINE_NAMES[i]) == 0) break;
+        }
+        if (IO_DISCIPLINE_NAMES[i] == NULL) {
+            fprintf(stderr, "Unknown I/O discipline %s, options are FIFO, SHORTEST, ELEVATOR\n", endptr + 1);
+            return -1;
+        }
+        discipline = (io_discipline_en)i;
+    }
+
+    io_device_t *dev = &io_devices[num_io_devices++];
+    memset(dev, 0, sizeof(*dev));
+    memcpy(dev->name, spec, (size_t)(colon - spec));
+    dev->channels = (uint32_t)channels;
+    dev->discipline = discipline;
+    dev->direction = 1;
+    return 0;
+}
+
+void io_init(void) {
+    if (num_io_devices == 0) {
+        io_add_device("disk:2:FIFO");
+    }
+}
+
+// Index of the device with the given name, -1 if there is none
+static int io_find_device(const char *name, size_t size) {
+    for (int d = 0; d < num_io_devices; d++) {
+        if (strncmp(io_devices[d].name, name, size) == 0) return d;
+    }
+    return -1;
+}
+
+void io_submit(pcb_t *pcb, const char *device, uint32_t position, uint32_t current_time_ms) {
+    int d = -1;
+    if (device[0] != '\0') {
+        d = io_find_device(device, MSG_DEVICE_LEN);
+        if (d < 0) {
+            fprintf(stderr, "Process %d requested unknown I/O device %.*s\n",
+                    pcb->pid, MSG_DEVICE_LEN, device);
+        }
+    }
+    if (d < 0) d = (int)((uint32_t)pcb->pid % (uint32_t)num_io_devices);
+    pcb->io_device = d;
+    pcb->io_position = position;
+    pcb->io_wait_start_ms = current_time_ms;
+    enqueue_pcb(&io_devices[pcb->io_device].wait_queue, pcb);
+}
+
+// Select the next request to be served according to the discipline of the device
+static queue_elem_t *io_select(io_device_t *dev) {
+    queue_elem_t *best = NULL;
+    queue_elem_t *elem;
+
+    switch (dev->discipline) {
+        case IO_SCHED_SHORTEST:
+            for (elem = dev->wait_queue.head; elem != NULL; elem = elem->next) {
+                if (best == NULL || elem->pcb->time_ms < best->pcb->time_ms) best = elem;
+            }
+            return best;
+        case IO_SCHED_ELEVATOR: {
+            // Closest request ahead of the head, in the order of arrival for the same position
+            int64_t best_dist = 0;
+            for (int pass = 0; pass < 2 && best == NULL; pass++) {
+                for (elem = dev->wait_queue.head; elem != NULL; elem = elem->next) {
+                    int64_t dist = ((int64_t)elem->pcb->io_position - dev->head_pos) * dev->direction;
+                    if (dist < 0) continue;
+                    if (best == NULL || dist < best_dist) {
+                        best = elem;
+                        best_dist = dist;
+                    }
+                }
+                if (best == NULL) dev->direction = -dev->direction;  // End of the sweep, reverse
+            }
+            return best;
+        }
+        case IO_SCHED_FIFO:
+        default:
+            return dev->wait_queue.head;
+    }
+}
+
+void io_start_requests(task_table_t *blocked_tasks, uint32_t current_time_ms) {
+    for (int d = 0; d < num_io_devices; d++) {
+        io_device_t *dev = &io_devices[d];
+        while (dev->busy_channels < dev->channels && dev->wait_queue.head != NULL) {
+            queue_elem_t *elem = io_select(dev);
+            pcb_t *pcb = elem->pcb;
+            if (task_table_add(blocked_tasks, pcb, pcb->time_ms) != 0) {
+                // Leave the request waiting for the channel, try again on the next tick
+                fprintf(stderr, "Could not start the I/O of process %d on device %s\n", pcb->pid, dev->name);
+                break;
+            }
+            remove_queue_elem(&dev->wait_queue, elem);
+            free(elem);
+            dev->head_pos = pcb->io_position;
+
+            uint32_t waited = current_time_ms - pcb->io_wait_start_ms;
+            dev->wait_ms += waited;
+            if (waited > dev->max_wait_ms) dev->max_wait_ms = waited;
+            dev->requests++;
+            dev->busy_channels++;
+
+            pcb->last_update_time_ms = current_time_ms;
+            DBG("Process %d started I/O on device %s for %u ms after waiting %u ms\n",
+                pcb->pid, dev->name, pcb->time_ms, waited);
+        }
+    }
+}
+
+void io_complete(const pcb_t *pcb) {
+    io_device_t *dev = &io_devices[pcb->io_device];
+    if (dev->busy_channels > 0) dev->busy_channels--;
+}
+
+void io_account_tick(void) {
+    for (int d = 0; d < num_io_devices; d++) {
+        io_devices[d].busy_ms += (uint64_t)io_devices[d].busy_channels * TICKS_MS;
+    }
+}
+
+int io_waiting_count(void) {
+    int count = 0;
+    for (int d = 0; d < num_io_devices; d++) {
+        count += io_devices[d].wait_queue.size;
+    }
+    return count;
+}
+
+void io_print_stats(FILE *out, uint32_t current_time_ms) {
+    for (int d = 0; d < num_io_devices; d++) {
+        const io_device_t *dev = &io_devices[d];
+        double capacity_ms = (double)dev->channels * current_time_ms;
+        fprintf(out, "  Device %s (%u channels, %s): %" PRIu64 " requests, utilization %.2f%%, "
+                "queue wait avg %.1f ms, max %u ms\n",
+                dev->name, dev->channels, IO_DISCIPLINE_NAMES[dev->discipline],
+                dev->requests,
+                capacity_ms > 0 ? 100.0 * (double)dev->busy_ms / capacity_ms : 0.0,
+                dev->requests ? (double)dev->wait_ms / (double)dev->requests : 0.0,
+                dev->max_wait_ms);
+    }
+}
+
+void io_checkpoint(checkpoint_t *ck) {
+    uint32_t num_devices = (uint32_t)num_io_devices;
+    ckpt_u32(ck, &num_devices);
+    if (num_devices != (uint32_t)num_io_devices) {
+        ckpt_fail(ck, "the checkpoint was saved with different I/O devices");
+        return;
+    }
+    for (int d = 0; d < num_io_devices; d++) {
+        io_device_t *dev = &io_devices[d];
+        ckpt_queue(ck, &dev->wait_queue);
+        ckpt_u32(ck, &dev->busy_channels);
+        ckpt_bytes(ck, &dev->head_pos, sizeof(dev->head_pos));
+        ckpt_bytes(ck, &dev->direction, sizeof(dev->direction));
+        ckpt_bytes(ck, &dev->requests, sizeof(dev->requests));
+        ckpt_bytes(ck, &dev->busy_ms, sizeof(dev->busy_ms));
+        ckpt_bytes(ck, &dev->wait_ms, sizeof(dev->wait_ms));
+        ckpt_u32(ck, &dev->max_wait_ms);
+    }
+}
@@ -0,0 +1,110 @@
+#ifndef IODEV_H
+#define IODEV_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include "checkpoint.h"
+#include "queue.h"
+#include "tasktab.h"
+
+#define MAX_IO_DEVICES 8
+#define IO_DEVICE_NAME_LEN 16
+
+// Order in which the requests waiting for a device are served
+typedef enum {
+    IO_SCHED_FIFO = 0,      // By order of arrival
+    IO_SCHED_SHORTEST,      // Shortest request first
+    IO_SCHED_ELEVATOR,      // SCAN: sweep the device in one direction, then reverse
+} io_discipline_en;
+
+// An I/O device with a limited number of channels (requests served at the same time)
+typedef struct {
+    char name[IO_DEVICE_NAME_LEN];
+    uint32_t channels;              // Number of requests the device can serve at the same time
+    io_discipline_en discipline;    // How the waiting requests are selected
+    queue_t wait_queue;             // Requests waiting for a free channel
+    uint32_t busy_channels;         // Channels currently serving a request
+    uint32_t head_pos;              // Current position of the elevator
+    int direction;                  // Direction of the elevator (+1 or -1)
+    // Statistics
+    uint64_t requests;              // Requests that started being served
+    uint64_t busy_ms;               // Sum of the busy time of all channels
+    uint64_t wait_ms;               // Sum of the time requests waited for a channel
+    uint32_t max_wait_ms;           // Longest time a request waited for a channel
+} io_device_t;
+
+/**
+ * @brief Add an I/O device from a "name:channels[:discipline]" description
+ *
+ * The discipline is one of FIFO, SHORTEST or ELEVATOR (FIFO if omitted).
+ *
+ * @param spec The description of the device
+ * @return 0 on success, -1 if the description is invalid or there are too many devices
+ */
+int io_add_device(const char *spec);
+
+/**
+ * @brief Create the default device if no device was configured
+ */
+void io_init(void);
+
+/**
+ * @brief Submit a BLOCK request to a device
+ *
+ * The request waits in the queue of the device until a channel is free, and only
+ * then its countdown starts. Requests that name no device are spread over the
+ * devices by PID, as are requests for an unknown device (with a warning).
+ *
+ * @param pcb             The task that requested the I/O (time_ms holds the request time)
+ * @param device          Name of the device requested, empty for any device
+ * @param position        Position of the request on the device, used by ELEVATOR
+ * @param current_time_ms Current simulation time in milliseconds
+ */
+void io_submit(pcb_t *pcb, const char *device, uint32_t position, uint32_t current_time_ms);
+
+/**
+ * @brief Start the waiting requests on the free channels of every device
+ *
+ * A request that cannot be added to the table stays in the queue of its device,
+ * and is started again on a later tick.
+ *
+ * @param blocked_tasks   The table with the requests being served, where started requests are added
+ * @param current_time_ms Current simulation time in milliseconds
+ */
+void io_start_requests(task_table_t *blocked_tasks, uint32_t current_time_ms);
+
+/**
+ * @brief Release the channel used by a request that finished
+ *
+ * @param pcb The task whose I/O request finished
+ */
+void io_complete(const pcb_t *pcb);
+
+/**
+ * @brief Account one tick of busy time on the devices
+ */
+void io_account_tick(void);
+
+/**
+ * @brief Number of requests waiting for a channel on all devices
+ */
+int io_waiting_count(void);
+
+/**
+ * @brief Print the utilization and queue wait of each device
+ *
+ * @param out             The stream where the statistics will be printed
+ * @param current_time_ms Current simulation time in milliseconds
+ */
+void io_print_stats(FILE *out, uint32_t current_time_ms);
+
+/**
+ * @brief Save or restore the queues, channels and statistics of the I/O devices
+ *
+ * The devices must be configured with the same options as when the checkpoint was saved.
+ *
+ * @param ck The checkpoint
+ */
+void io_checkpoint(checkpoint_t *ck);
+
+#endif // IODEV_H
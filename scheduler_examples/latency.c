@@ -0,0 +1,73 @@
+#include "latency.h"
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <sys/file.h>
+#include <time.h>
+
+#include "hist.h"
+
+static const char *LATENCY_NAMES[LATENCY_COUNT] = {
+    "RUN->ACK",
+    "BLOCK->ACK",
+    "DONE-delivery",
+};
+
+static hist_t latency_hist[LATENCY_COUNT];
+
+uint64_t latency_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+void latency_record(latency_en kind, uint64_t duration) {
+    hist_record(&latency_hist[kind], duration);
+}
+
+void latency_record_since(latency_en kind, uint64_t sent_ns) {
+    if (sent_ns == 0) return;
+    uint64_t now = latency_now_ns();
+    latency_record(kind, now > sent_ns ? now - sent_ns : 0);
+}
+
+void latency_print(FILE *out, const char *app_name, pid_t pid) {
+    for (int k = 0; k < LATENCY_COUNT; k++) {
+        const hist_t *h = &latency_hist[k];
+        if (h->count == 0) continue;
+        fprintf(out, "Application %s (PID %d) %-13s latency (us): count %" PRIu64
+                ", avg %.1f, p50 <%.1f, p99 <%.1f, max %.1f\n",
+                app_name, pid, LATENCY_NAMES[k], h->count,
+                (double)h->total_ns / (double)h->count / 1000.0,
+                (double)hist_percentile(h, 0.5) / 1000.0,
+                (double)hist_percentile(h, 0.99) / 1000.0,
+                (double)h->max_ns / 1000.0);
+    }
+}
+
+int latency_export(const char *app_name, pid_t pid) {
+    const char *path = getenv("OSSIM_LATENCY");
+    if (path == NULL || *path == '\0') return 0;
+
+    FILE *file = fopen(path, "a");
+    if (file == NULL) {
+        perror("fopen");
+        return -1;
+    }
+    // One application at a time, so the lines are not interleaved
+    flock(fileno(file), LOCK_EX);
+    for (int k = 0; k < LATENCY_COUNT; k++) {
+        const hist_t *h = &latency_hist[k];
+        if (h->count == 0) continue;
+        fprintf(file, "%s %d %s %" PRIu64 " %" PRIu64 " %" PRIu64 " %" PRIu64,
+                app_name, pid, LATENCY_NAMES[k], h->count, h->total_ns, h->min_ns, h->max_ns);
+        for (int b = 0; b < HIST_BUCKETS; b++) {
+            fprintf(file, " %" PRIu64, h->buckets[b]);
+        }
+        fprintf(file, "\n");
+    }
+    fflush(file);
+    flock(fileno(file), LOCK_UN);
+    fclose(file);
+    return 0;
+}
@@ -0,0 +1,73 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/types.h>
+
+/*
+ * Real (wall clock) latency of the exchanges of an application with the simulator.
+ * The simulated times in the ACK/DONE messages say when things happened in the
+ * simulation; these histograms say how long the messages themselves took, measured
+ * with CLOCK_MONOTONIC, so the overhead of the simulator and of the socket can be
+ * told apart from the scheduling delay. Each kind of exchange has a histogram with
+ * power of two buckets (see hist.h), like the phase timing of the simulator.
+ */
+
+typedef enum {
+    LATENCY_RUN_ACK = 0,    // From writing a RUN request to reading its ACK
+    LATENCY_BLOCK_ACK,      // From writing a BLOCK request to reading its ACK
+    LATENCY_DONE,           // From the simulator writing a DONE message to the application reading it
+    LATENCY_COUNT
+} latency_en;
+
+/**
+ * @brief Current time of the monotonic clock in nanoseconds
+ *
+ * The clock is shared by all the processes of the machine, so it can be compared
+ * with the sent_ns field of the messages of the simulator.
+ */
+uint64_t latency_now_ns(void);
+
+/**
+ * @brief Record the duration of one exchange
+ *
+ * @param kind     The kind of exchange
+ * @param duration The duration in nanoseconds
+ */
+void latency_record(latency_en kind, uint64_t duration);
+
+/**
+ * @brief Record the delivery delay of a message, from the time the simulator wrote it
+ *
+ * Messages without a send time (sent_ns == 0) are ignored.
+ *
+ * @param kind    The kind of exchange
+ * @param sent_ns The send time in the message
+ */
+void latency_record_since(latency_en kind, uint64_t sent_ns);
+
+/**
+ * @brief Print a summary of the histograms (count, average, percentiles and maximum)
+ *
+ * @param out      The stream where the summary will be printed
+ * @param app_name The name of the application
+ * @param pid      The PID of the application
+ */
+void latency_print(FILE *out, const char *app_name, pid_t pid);
+
+/**
+ * @brief Append the histograms to the file named by the OSSIM_LATENCY environment variable
+ *
+ * Each kind of exchange is written as one line with the application, the PID, the
+ * kind, the count, the total, the minimum and maximum, and the count of each bucket.
+ * The file is locked while writing, so all the applications of a scenario can share
+ * it. Nothing is written if the variable is not set.
+ *
+ * @param app_name The name of the application
+ * @param pid      The PID of the application
+ * @return 0 on success or if the variable is not set, -1 on failure
+ */
+int latency_export(const char *app_name, pid_t pid);
+
+#endif // LATENCY_H
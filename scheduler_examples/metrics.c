@@ -0,0 +1,201 @@
+#include "metrics.h"
+
+#include <errno.h>
+#include <inttypes.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "debug.h"
+#include "stats.h"
+
+// Time the metrics thread waits for a connection before checking if it must stop
+#define METRICS_POLL_MS 100
+// Time a client has to send its (optional) HTTP request
+#define METRICS_REQUEST_WAIT_MS 10
+// Time a client has to read the reply, so a stalled one cannot block the thread
+#define METRICS_SEND_TIMEOUT_MS 1000
+
+typedef struct {
+    const char *name;
+    const char *type;
+    const char *help;
+    stat_t *value;
+} metric_desc_t;
+
+static const metric_desc_t METRICS[] = {
+    {"ossim_sim_time_ms", "gauge", "Current simulation time in milliseconds.", &sim_stats.sim_time_ms},
+    {"ossim_busy_cpus", "gauge", "CPUs with a task assigned.", &sim_stats.busy_cpus},
+    {"ossim_online_cpus", "gauge", "CPUs online.", &sim_stats.online_cpus},
+    {"ossim_online_capacity_pct", "gauge", "Capacity of the online CPUs, in percent of a big core.", &sim_stats.online_capacity_pct},
+    {"ossim_online_cpu_ms_total", "counter", "Online CPUs integrated over time, in CPU milliseconds.", &sim_stats.online_cpu_ms},
+    {"ossim_hotplug_evictions_total", "counter", "Tasks sent back to the ready queue when their CPU went offline.", &sim_stats.hotplug_evictions},
+    {"ossim_dispatches_total", "counter", "Tasks placed on a CPU.", &sim_stats.dispatches},
+    {"ossim_context_switches_total", "counter", "Dispatches on a CPU that last ran another task.", &sim_stats.context_switches},
+    {"ossim_preemptions_total", "counter", "Running tasks sent back to the ready queue.", &sim_stats.preemptions},
+    {"ossim_wakeup_preemptions_total", "counter", "Running tasks preempted by a ready task of a higher MLFQ level.", &sim_stats.wakeup_preemptions},
+    {"ossim_migrations_total", "counter", "Dispatches on a different CPU than the previous one.", &sim_stats.migrations},
+    {"ossim_remote_migrations_total", "counter", "Migrations to a CPU on another node.", &sim_stats.remote_migrations},
+    {"ossim_migration_penalty_ms_total", "counter", "Burst time added because of migrations.", &sim_stats.migration_penalty_ms},
+    {"ossim_switch_overhead_ms_total", "counter", "CPU time spent in context switches.", &sim_stats.switch_overhead_ms},
+    {"ossim_connections_total", "counter", "Connections accepted from applications.", &sim_stats.connections},
+    {"ossim_messages_received_total", "counter", "Messages received from applications.", &sim_stats.messages_in},
+    {"ossim_messages_sent_total", "counter", "Messages sent to applications.", &sim_stats.messages_out},
+    {"ossim_gang_dispatches_total", "counter", "Parallel tasks placed on their CPUs.", &sim_stats.gang_dispatches},
+    {"ossim_gang_blocked_ms_total", "counter", "Time the first parallel task did not fit in the idle CPUs.", &sim_stats.gang_blocked_ms},
+    {"ossim_gang_reserved_ms_total", "counter", "Time single-CPU tasks were held back by the reservation of a parallel task.", &sim_stats.gang_reserved_ms},
+    {"ossim_up_migrations_total", "counter", "Running tasks moved to a bigger core.", &sim_stats.up_migrations},
+    {"ossim_down_migrations_total", "counter", "Running tasks moved to a smaller core.", &sim_stats.down_migrations},
+    {"ossim_energy_uj_total", "counter", "Energy consumed by the CPUs in microjoules.", &sim_stats.energy_uj},
+    {"ossim_wasted_cpu_ms_total", "counter", "Idle CPU time while tasks were waiting.", &sim_stats.wasted_cpu_ms},
+    {"ossim_group_overflows_total", "counter", "Tasks put in the default group because all the group slots had tasks.", &sim_stats.group_overflows},
+    {"ossim_groups_recycled_total", "counter", "Groups without tasks whose slot was given to a new group.", &sim_stats.groups_recycled},
+    {NULL, NULL, NULL, NULL}
+};
+
+static pthread_t metrics_thread;
+static atomic_int metrics_running = 0;
+static int metrics_fd = -1;
+static int (*cpus_handler)(int num_cpus) = NULL;
+
+void metrics_set_cpus_handler(int (*handler)(int num_cpus)) {
+    cpus_handler = handler;
+}
+
+static uint64_t load(stat_t *value) {
+    return atomic_load_explicit(value, memory_order_relaxed);
+}
+
+// Write a snapshot of all metrics in the Prometheus text format
+static void write_metrics(FILE *out) {
+    for (int i = 0; METRICS[i].name != NULL; i++) {
+        fprintf(out, "# HELP %s %s\n# TYPE %s %s\n%s %" PRIu64 "\n",
+                METRICS[i].name, METRICS[i].help, METRICS[i].name, METRICS[i].type,
+                METRICS[i].name, load(METRICS[i].value));
+    }
+
+    fprintf(out, "# HELP ossim_queue_length Number of tasks in each queue.\n"
+                 "# TYPE ossim_queue_length gauge\n");
+    fprintf(out, "ossim_queue_length{queue=\"command\"} %" PRIu64 "\n", load(&sim_stats.command_queue_len));
+    fprintf(out, "ossim_queue_length{queue=\"ready\"} %" PRIu64 "\n", load(&sim_stats.ready_queue_len));
+    fprintf(out, "ossim_queue_length{queue=\"blocked\"} %" PRIu64 "\n", load(&sim_stats.blocked_queue_len));
+    fprintf(out, "ossim_queue_length{queue=\"io_wait\"} %" PRIu64 "\n", load(&sim_stats.io_wait_queue_len));
+
+    int num_cpus = topo_num_cpus();
+    fprintf(out, "# HELP ossim_cpu_busy_ms_total Time each CPU had a task assigned.\n"
+                 "# TYPE ossim_cpu_busy_ms_total counter\n");
+    for (int i = 0; i < num_cpus; i++) {
+        fprintf(out, "ossim_cpu_busy_ms_total{cpu=\"%d\",node=\"%d\"} %" PRIu64 "\n",
+                i, topo_socket(i), load(&sim_stats.cpu_busy_ms[i]));
+    }
+    fprintf(out, "# HELP ossim_cpu_idle_ms_total Time each CPU was idle.\n"
+                 "# TYPE ossim_cpu_idle_ms_total counter\n");
+    for (int i = 0; i < num_cpus; i++) {
+        fprintf(out, "ossim_cpu_idle_ms_total{cpu=\"%d\",node=\"%d\"} %" PRIu64 "\n",
+                i, topo_socket(i), load(&sim_stats.cpu_idle_ms[i]));
+    }
+}
+
+// Send a whole buffer; a client that disconnects or stalls is dropped without a SIGPIPE
+static void send_all(int client_fd, const char *buf, size_t len) {
+    while (len > 0) {
+        ssize_t sent = send(client_fd, buf, len, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            DBG("[Metrics] Client on fd=%d dropped: %s\n", client_fd, strerror(errno));
+            return;
+        }
+        buf += sent;
+        len -= (size_t)sent;
+    }
+}
+
+static void serve_client(int client_fd) {
+    // Plain clients (e.g. socat) just read; HTTP clients send a request first
+    char request[512];
+    ssize_t n = 0;
+    struct pollfd pfd = {.fd = client_fd, .events = POLLIN};
+    if (poll(&pfd, 1, METRICS_REQUEST_WAIT_MS) > 0) {
+        n = read(client_fd, request, sizeof(request) - 1);
+    }
+    int http = (n >= 4 && strncmp(request, "GET ", 4) == 0);
+
+    // "cpus N" changes the number of online CPUs instead of reading the metrics
+    int num_cpus;
+    if (n > 0) request[n] = '\0';
+    if (n >= 5 && sscanf(request, "cpus %d", &num_cpus) == 1) {
+        const char *reply = (cpus_handler == NULL) ? "not supported\n"
+                          : (cpus_handler(num_cpus) == 0) ? "ok\n" : "invalid number of CPUs\n";
+        send_all(client_fd, reply, strlen(reply));
+        return;
+    }
+
+    char *body = NULL;
+    size_t body_len = 0;
+    FILE *out = open_memstream(&body, &body_len);
+    if (!out) {
+        perror("open_memstream");
+        return;
+    }
+    write_metrics(out);
+    fclose(out);
+
+    if (http) {
+        char header[128];
+        int header_len = snprintf(header, sizeof(header),
+                                  "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\n"
+                                  "Content-Length: %zu\r\n\r\n", body_len);
+        send_all(client_fd, header, (size_t)header_len);
+    }
+    send_all(client_fd, body, body_len);
+    free(body);
+}
+
+static void *metrics_thread_main(void *arg) {
+    (void)arg;
+    while (atomic_load(&metrics_running)) {
+        struct pollfd pfd = {.fd = metrics_fd, .events = POLLIN};
+        int ready = poll(&pfd, 1, METRICS_POLL_MS);
+        if (ready < 0 && errno != EINTR) {
+            perror("poll");
+            break;
+        }
+        if (ready <= 0) continue;
+
+        int client_fd = accept(metrics_fd, NULL, NULL);
+        if (client_fd < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) perror("accept");
+            continue;
+        }
+        DBG("[Metrics] Serving scrape on fd=%d\n", client_fd);
+        struct timeval timeout = {.tv_sec = METRICS_SEND_TIMEOUT_MS / 1000,
+                                  .tv_usec = (METRICS_SEND_TIMEOUT_MS % 1000) * 1000};
+        setsockopt(client_fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        serve_client(client_fd);
+        close(client_fd);
+    }
+    return NULL;
+}
+
+int metrics_start(int server_fd) {
+    metrics_fd = server_fd;
+    atomic_store(&metrics_running, 1);
+    int err = pthread_create(&metrics_thread, NULL, metrics_thread_main, NULL);
+    if (err != 0) {
+        fprintf(stderr, "pthread_create: failed to start the metrics thread (%d)\n", err);
+        atomic_store(&metrics_running, 0);
+        return -1;
+    }
+    return 0;
+}
+
+void metrics_stop(void) {
+    if (!atomic_load(&metrics_running)) return;
+    atomic_store(&metrics_running, 0);
+    pthread_join(metrics_thread, NULL);
+}
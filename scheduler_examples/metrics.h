@@ -0,0 +1,34 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+/*
+ * Live metrics endpoint.
+ * A thread serves the statistics of the simulator in the Prometheus text exposition
+ * format on a UNIX socket. Each connection receives one snapshot and is closed.
+ * If the client sends an HTTP request, the snapshot is sent as an HTTP response.
+ * The values are read from the atomic counters in stats.h, so a scrape never
+ * blocks the scheduling thread.
+ * A client can also send "cpus N" to change the number of online CPUs.
+ */
+
+/**
+ * @brief Start the metrics thread
+ *
+ * @param server_fd The listening socket where the scrapes are accepted
+ * @return 0 on success, -1 on failure
+ */
+int metrics_start(int server_fd);
+
+/**
+ * @brief Stop the metrics thread
+ */
+void metrics_stop(void);
+
+/**
+ * @brief Set the function that handles the "cpus N" command (before metrics_start())
+ *
+ * @param handler Called from the metrics thread with N, returns 0 if accepted
+ */
+void metrics_set_cpus_handler(int (*handler)(int num_cpus));
+
+#endif // METRICS_H
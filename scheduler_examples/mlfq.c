@@ -5,17 +5,38 @@
 
 #include "msg.h"
 #include <unistd.h>
+#include "cpu.h"
 #include "debug.h"
-
-static const uint32_t level_quantum_ms[MLFQ_LEVELS] = { 500, 1000, 2000 }; // Quantum de cada nível (0.5s, 1s, 2s)
+#include "params.h"
+#include "probes.h"
+#include "stats.h"
+
+// Quantum de cada nível (por omissão 0.5s, 1s, 2s), configurável com -p mlfq_quantumN_ms
+static uint32_t level_quantum_ms(int level) {
+    const uint32_t quantum_ms[MLFQ_LEVELS] = {
+        sim_params.mlfq_quantum0_ms, sim_params.mlfq_quantum1_ms, sim_params.mlfq_quantum2_ms
+    };
+    return quantum_ms[level];
+}
 
 typedef struct {
     uint32_t pid;   // ID do processo
     int level;      // nível de prioridade (0 = alta, 2 = baixa)
     uint32_t run_ms;// tempo já gasto neste nível
+    uint32_t wait_ms;// tempo de espera na fila (para aging)
+    uint32_t boost_ms;// tempo de CPU que ainda corre com o boost de I/O
 } meta_t;
 
+// Nível usado para escolher entre tarefas: uma tarefa com boost de I/O fica acima do nível 0
+#define BOOST_LEVEL (-1)
+
+static int effective_level(const meta_t *m) {
+    if (m == NULL) return 0;
+    return (m->boost_ms > 0) ? BOOST_LEVEL : m->level;
+}
+
 static meta_t meta_tbl[MAX_META] = {0}; // tabela para armazenar info de todos os processos
+static uint32_t last_aging_time = 0;     // instante do último aging
 
 // Função auxiliar: encontra ou cria entrada meta_t para um processo
 static meta_t *m_find(uint32_t pid) {
@@ -28,6 +49,8 @@ static meta_t *m_find(uint32_t pid) {
             meta_tbl[i].pid = pid;
             meta_tbl[i].level = 0;
             meta_tbl[i].run_ms = 0;
+            meta_tbl[i].wait_ms = 0;
+            meta_tbl[i].boost_ms = 0;
             return &meta_tbl[i];
         }
     }
@@ -41,23 +64,25 @@ static void m_remove(uint32_t pid) {
             meta_tbl[i].pid = 0;
             meta_tbl[i].level = 0;
             meta_tbl[i].run_ms = 0;
+            meta_tbl[i].wait_ms = 0;
+            meta_tbl[i].boost_ms = 0;
             return;
         }
     }
 }
 
 // Função auxiliar: encontra o processo de maior prioridade na fila
-static pcb_t* find_highest_priority(queue_t *rq, int *highest_level) {
+// Ignora os processos que estão à espera de ficar livre a CPU onde correram antes
+static pcb_t* find_highest_priority(queue_t *rq, pcb_t **cpus, int num_cpus, int *highest_level) {
     pcb_t *highest = NULL;
     *highest_level = MLFQ_LEVELS; // Inicializa com o pior nível possível
 
     queue_elem_t *elem = rq->head;
     while (elem != NULL) {
         pcb_t *p = elem->pcb;
-        meta_t *m = m_find(p->pid);
-        int level = (m != NULL) ? m->level : 0;
+        int level = effective_level(m_find(p->pid));
 
-        if (level < *highest_level) {
+        if (level < *highest_level && cpu_select(p, cpus, num_cpus) >= 0) {
             *highest_level = level;
             highest = p;
         }
@@ -78,6 +103,7 @@ static void remove_pcb_from_queue(queue_t *rq, pcb_t *pcb) {
         if (rq->head == NULL) {
             rq->tail = NULL;
         }
+        rq->size--;
         free(to_remove);
         return;
     }
@@ -92,6 +118,7 @@ static void remove_pcb_from_queue(queue_t *rq, pcb_t *pcb) {
             if (current == rq->tail) {
                 rq->tail = prev;
             }
+            rq->size--;
             free(current);
             return;
         }
@@ -109,40 +136,34 @@ void mlfq_scheduler(uint32_t current_time_ms, queue_t *rq, pcb_t **cpus, int num
         pcb_t *p = cpus[i];
         if (p == NULL) continue;
 
-        // Atualiza tempo decorrido
-        p->ellapsed_time_ms += TICKS_MS;
+        // Atualiza tempo decorrido (sem contar a troca de contexto)
+        uint32_t progress_ms = cpu_run_tick(cpus, i);
+        p->ellapsed_time_ms += progress_ms;
 
         // Atualiza tempo no nível atual
         meta_t *m = m_find(p->pid);
         if (m != NULL) {
-            m->run_ms += TICKS_MS;
+            m->run_ms += progress_ms;
+            m->boost_ms = (m->boost_ms > progress_ms) ? m->boost_ms - progress_ms : 0;
         }
 
         // Se o processo terminou
         if (p->ellapsed_time_ms >= p->time_ms) {
             DBG("Process %d finished CPU burst on CPU %d (MLFQ)\n", p->pid, i);
 
-            msg_t msg = {
-                .pid = p->pid,
-                .request = PROCESS_REQUEST_DONE,
-                .time_ms = current_time_ms
-            };
-            write(p->sockfd, &msg, sizeof(msg_t));
-
             // Limpa metadados
             m_remove(p->pid);
 
-            // Atualiza estado
-            p->status = TASK_COMMAND;
-            p->ellapsed_time_ms = 0;
-            cpus[i] = NULL;
+            // Envia DONE e liberta a CPU
+            cpu_burst_done(cpus, i, current_time_ms);
             continue;
         }
 
         // Se atingiu o quantum do nível atual
-        if (m != NULL && m->run_ms >= level_quantum_ms[m->level]) {
+        if (m != NULL && m->run_ms >= level_quantum_ms(m->level)) {
             DBG("Process %d preempted on CPU %d (quantum expired in level %d)\n",
                 p->pid, i, m->level);
+            PROBE4(preempt_quantum, p->pid, i, m->level, current_time_ms);
 
             // Ajusta tempo restante
             p->time_ms -= p->ellapsed_time_ms;
@@ -150,6 +171,7 @@ void mlfq_scheduler(uint32_t current_time_ms, queue_t *rq, pcb_t **cpus, int num
 
             // Baixa de prioridade (se não estiver no último nível)
             if (m->level < MLFQ_LEVELS - 1) {
+                PROBE3(mlfq_demote, p->pid, m->level, m->level + 1);
                 m->level++;
             }
             m->run_ms = 0;
@@ -158,12 +180,12 @@ void mlfq_scheduler(uint32_t current_time_ms, queue_t *rq, pcb_t **cpus, int num
             p->status = TASK_RUNNING;
             enqueue_pcb(rq, p);
             cpus[i] = NULL;
+            STAT_ADD(preemptions, 1);
         }
     }
 
     // 2. Aging: promove processos que esperam muito tempo
-    static uint32_t last_aging_time = 0;
-    if (current_time_ms - last_aging_time > 1000) { // Aging a cada 1 segundo
+    if (current_time_ms - last_aging_time > sim_params.mlfq_aging_period_ms) { // Aging a cada período
         queue_elem_t *elem = rq->head;
         while (elem != NULL) {
             pcb_t *p = elem->pcb;
@@ -171,17 +193,17 @@ void mlfq_scheduler(uint32_t current_time_ms, queue_t *rq, pcb_t **cpus, int num
 
             if (m != NULL && m->level > 0) {
                 // Incrementa tempo de espera (simplificado)
-                static uint32_t waiting_time[256] = {0};
-                waiting_time[p->pid] += 1000;
+                m->wait_ms += sim_params.mlfq_aging_period_ms;
 
-                // Se esperou mais de 2 segundos, promove
-                if (waiting_time[p->pid] > 2000) {
+                // Se esperou mais que o limiar, promove
+                if (m->wait_ms > sim_params.mlfq_aging_threshold_ms) {
                     DBG("Process %d promoted from level %d due to aging\n",
                         p->pid, m->level);
+                    PROBE3(mlfq_promote, p->pid, m->level, m->level - 1);
 
                     m->level--;
                     m->run_ms = 0;
-                    waiting_time[p->pid] = 0;
+                    m->wait_ms = 0;
                 }
             }
             elem = elem->next;
@@ -190,30 +212,83 @@ void mlfq_scheduler(uint32_t current_time_ms, queue_t *rq, pcb_t **cpus, int num
     }
 
     // 3. Coloca processos da ready_queue nas CPUs livres
-    for (i = 0; i < num_cpus; i++) {
-        if (cpus[i] != NULL) continue; // CPU ocupada
-
+    while (cpu_first_free(cpus, num_cpus) >= 0) {
         // Encontra o processo de maior prioridade (menor nível)
         int highest_level;
-        pcb_t *highest = find_highest_priority(rq, &highest_level);
+        pcb_t *highest = find_highest_priority(rq, cpus, num_cpus, &highest_level);
 
         if (highest == NULL) break; // Nada para executar
 
         // Remove da fila
         remove_pcb_from_queue(rq, highest);
 
-        // Coloca na CPU
-        highest->status = TASK_RUNNING;
-        highest->ellapsed_time_ms = 0;
-        cpus[i] = highest;
+        // Coloca na CPU (de preferência a mesma onde correu antes)
+        int cpu = cpu_select(highest, cpus, num_cpus);
+        cpu_dispatch(highest, cpus, cpu, current_time_ms);
 
-        // Atualiza metadados
-        meta_t *m = m_find(highest->pid);
-        if (m != NULL) {
-            m->run_ms = 0; // Reinicia contador de quantum
-        }
+        // O contador de quantum (run_ms) já está a zero, exceto numa tarefa desalojada
+        // por outra de maior prioridade, que continua o quantum que tinha
 
         DBG("Process %d started on CPU %d from level %d (MLFQ)\n",
-            highest->pid, i, highest_level);
+            highest->pid, cpu, highest_level);
     }
-}
\ No newline at end of file
+
+    // 4. Preempção ao acordar: enquanto houver na fila uma tarefa de nível mais alto do
+    // que a tarefa de menor prioridade a correr, esta dá-lhe a CPU. Só quando não há
+    // CPUs livres: uma tarefa que ficou na fila com CPUs livres espera pela sua CPU anterior
+    while (sim_params.mlfq_wakeup_preempt && cpu_first_free(cpus, num_cpus) < 0) {
+        int highest_level = MLFQ_LEVELS;
+        queue_elem_t *best = NULL;
+        for (queue_elem_t *elem = rq->head; elem != NULL; elem = elem->next) {
+            int level = effective_level(m_find(elem->pcb->pid));
+            if (level < highest_level) {
+                highest_level = level;
+                best = elem;
+            }
+        }
+        if (best == NULL) break;
+
+        int victim = -1;
+        int victim_level = highest_level;
+        for (i = 0; i < num_cpus; i++) {
+            if (cpus[i] == NULL) continue;
+            int level = effective_level(m_find(cpus[i]->pid));
+            if (level > victim_level) {
+                victim = i;
+                victim_level = level;
+            }
+        }
+        if (victim < 0) break;  // Nenhuma tarefa a correr tem prioridade menor
+
+        pcb_t *p = cpus[victim];
+        pcb_t *next = best->pcb;
+        DBG("Process %d preempted on CPU %d by process %d (level %d > %d)\n",
+            p->pid, victim, next->pid, victim_level, highest_level);
+        PROBE4(preempt_wakeup, p->pid, next->pid, victim, current_time_ms);
+        p->time_ms -= p->ellapsed_time_ms;
+        p->ellapsed_time_ms = 0;
+        p->status = TASK_RUNNING;
+        cpus[victim] = NULL;
+        remove_pcb_from_queue(rq, next);
+        enqueue_pcb(rq, p);
+        cpu_dispatch(next, cpus, victim, current_time_ms);
+        STAT_ADD(preemptions, 1);
+        STAT_ADD(wakeup_preemptions, 1);
+    }
+}
+
+void mlfq_io_boost(int32_t pid) {
+    if (sim_params.mlfq_io_boost_ms == 0) return;
+    meta_t *m = m_find((uint32_t)pid);
+    if (m != NULL) m->boost_ms = sim_params.mlfq_io_boost_ms;
+}
+
+void mlfq_forget(int32_t pid) {
+    m_remove((uint32_t)pid);
+}
+
+void mlfq_checkpoint(checkpoint_t *ck) {
+    // A tabela só tem valores simples (o PID identifica o processo)
+    ckpt_bytes(ck, meta_tbl, sizeof(meta_tbl));
+    ckpt_u32(ck, &last_aging_time);
+}
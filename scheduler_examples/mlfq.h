@@ -1,6 +1,7 @@
 #ifndef MLFQ_H
 #define MLFQ_H
 
+#include "checkpoint.h"
 #include "queue.h"
 #include <stdint.h>
 
@@ -10,6 +11,10 @@
 /**
  * @brief MLFQ (Multi-Level Feedback Queue) scheduler com suporte a múltiplos CPUs
  *
+ * Com mlfq_wakeup_preempt=1, uma tarefa que fica pronta num nível mais alto do que
+ * a tarefa de menor prioridade a correr desaloja-a logo, em vez de esperar pelo fim
+ * do quantum dela.
+ *
  * @param current_time_ms Tempo atual da simulação em ms
  * @param ready_queue     Fila de processos prontos
  * @param cpus            Array de ponteiros para os processos em execução (um por CPU)
@@ -20,4 +25,25 @@ void mlfq_scheduler(uint32_t current_time_ms,
                     pcb_t **cpus,
                     int num_cpus);
 
+/**
+ * @brief Dá a um processo que acabou um pedido de I/O um boost temporário de prioridade
+ *
+ * Durante os próximos mlfq_io_boost_ms de CPU o processo é escolhido antes das tarefas
+ * de qualquer nível (e, com mlfq_wakeup_preempt, pode desalojá-las). Não faz nada se
+ * mlfq_io_boost_ms for 0.
+ */
+void mlfq_io_boost(int32_t pid);
+
+/**
+ * @brief Esquece o nível de um processo que saiu do simulador (desligado ou movido para outro shard)
+ */
+void mlfq_forget(int32_t pid);
+
+/**
+ * @brief Guarda ou restaura os níveis do MLFQ e o instante do último aging num checkpoint
+ *
+ * @param ck O checkpoint
+ */
+void mlfq_checkpoint(checkpoint_t *ck);
+
 #endif // MLFQ_H
@@ -0,0 +1,46 @@
+#ifndef MPSC_H
+#define MPSC_H
+
+#include <stdatomic.h>
+
+/*
+ * Lock-free multi-producer single-consumer queue (intrusive, Vyukov style).
+ * Any number of threads can push nodes at the same time, but only one thread may pop.
+ * The node is embedded in the element being queued, so pushing never allocates.
+ */
+
+typedef struct mpsc_node_st mpsc_node_t;
+struct mpsc_node_st {
+    _Atomic(mpsc_node_t *) next;
+};
+
+typedef struct {
+    _Atomic(mpsc_node_t *) head;    // Last node pushed (producers side)
+    mpsc_node_t *tail;              // Next node to pop (consumer side)
+    mpsc_node_t stub;               // Placeholder so the queue is never really empty
+} mpsc_queue_t;
+
+/**
+ * @brief Initialize an empty queue
+ *
+ * @param q The queue to initialize
+ */
+void mpsc_init(mpsc_queue_t *q);
+
+/**
+ * @brief Push a node to the queue (safe from any thread)
+ *
+ * @param q    The queue
+ * @param node The node to push, which must not be in any queue
+ */
+void mpsc_push(mpsc_queue_t *q, mpsc_node_t *node);
+
+/**
+ * @brief Pop the oldest node from the queue (only from the consumer thread)
+ *
+ * @param q The queue
+ * @return The node, or NULL if the queue is empty (or a push is still in progress)
+ */
+mpsc_node_t *mpsc_pop(mpsc_queue_t *q);
+
+#endif // MPSC_H
@@ -10,8 +10,11 @@
 #include <sys/types.h>
 
 #define SOCKET_PATH "/tmp/scheduler.sock"
+#define STATS_SOCKET_PATH "/tmp/scheduler-stats.sock"
 
 #define MAX_PAGES 32
+#define MSG_GROUP_LEN 16
+#define MSG_DEVICE_LEN 16
 
 // Define process request strings for debugging purposes
 static const char PROCESS_REQUEST_STRINGS[][10] = {
@@ -42,6 +45,11 @@ typedef struct {
     pid_t pid;                      // Process ID
     process_request_t request;      // Request type
     uint32_t time_ms;               // Time information
+    uint32_t parallelism;           // CPUs needed at the same time by a RUN request (0 or 1 for a serial task)
+    char group[MSG_GROUP_LEN];      // Group (tenant) of the application, empty for the default group
+    char device[MSG_DEVICE_LEN];    // I/O device of a BLOCK request, empty to spread the requests by PID
+    uint32_t position;              // Position of a BLOCK request on its device (e.g. block address)
+    uint64_t sent_ns;               // CLOCK_MONOTONIC time when the simulator wrote the message (0 if not set)
 } msg_t;
 
 
@@ -0,0 +1,499 @@
+#include "netio.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "debug.h"
+#include "probes.h"
+#include "shard.h"
+#include "stats.h"
+
+// Time the I/O thread waits for socket activity before checking the outgoing queue
+#define NETIO_POLL_MS 1
+
+// Time given at exit to the messages that could not be written yet
+#define NETIO_DRAIN_MS 1000
+
+typedef enum {
+    NET_OUT_MESSAGE = 0,    // Write a message to the socket
+    NET_OUT_CLOSE,          // Close the socket
+    NET_OUT_MIGRATE,        // Pass the socket and the message to the router, and close it
+} net_out_type_en;
+
+typedef struct {
+    mpsc_node_t node;       // Must be the first field
+    net_out_type_en type;
+    int sockfd;
+    msg_t msg;
+    shard_task_t task;      // NET_OUT_MIGRATE only
+} net_out_t;
+
+// Connection handled by the I/O thread
+typedef struct {
+    int sockfd;
+    int open;               // 0 after the remote side closed (waiting for netio_close)
+    size_t received;        // Bytes of the message being received
+    msg_t msg;              // Message being received
+    char *unsent;           // Bytes not written yet (socket full), sent on POLLOUT
+    size_t unsent_len;
+    size_t unsent_cap;
+    int close_after;        // -1, or NET_OUT_CLOSE/NET_OUT_MIGRATE once the unsent bytes are written
+    shard_task_t migrate;   // Task of NET_OUT_MIGRATE
+} net_client_t;
+
+static mpsc_queue_t in_queue;   // I/O thread -> scheduling thread
+static mpsc_queue_t out_queue;  // scheduling thread -> I/O thread
+
+static pthread_t io_thread;
+static atomic_int io_running = 0;
+static int listen_fd = -1;
+static int ctl_fd = -1;             // Control socket of a shard (instead of listen_fd)
+static const netio_loopback_t *loopback = NULL;
+
+static net_client_t *clients = NULL;
+static int num_clients = 0;
+static int max_clients = 0;
+
+static void push_event(net_event_type_en type, int sockfd, const msg_t *msg) {
+    net_event_t *event = malloc(sizeof(net_event_t));
+    if (!event) {
+        perror("malloc");
+        return;
+    }
+    event->type = type;
+    event->sockfd = sockfd;
+    if (msg) event->msg = *msg;
+    mpsc_push(&in_queue, &event->node);
+}
+
+static void push_migrate_event(int sockfd, const shard_task_t *task) {
+    net_event_t *event = malloc(sizeof(net_event_t));
+    if (!event) {
+        perror("malloc");
+        return;
+    }
+    event->type = NET_EVENT_MIGRATE_IN;
+    event->sockfd = sockfd;
+    event->msg = task->request;
+    event->client_time_ms = task->client_time_ms;
+    event->waited_ms = task->waited_ms;
+    mpsc_push(&in_queue, &event->node);
+}
+
+static void push_out(net_out_type_en type, int sockfd, const msg_t *msg) {
+    net_out_t *out = malloc(sizeof(net_out_t));
+    if (!out) {
+        perror("malloc");
+        return;
+    }
+    out->type = type;
+    out->sockfd = sockfd;
+    if (msg) out->msg = *msg;
+    mpsc_push(&out_queue, &out->node);
+}
+
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+}
+
+static int add_client(int sockfd) {
+    if (num_clients == max_clients) {
+        int new_max = max_clients ? max_clients * 2 : 64;
+        net_client_t *tmp = realloc(clients, (size_t)new_max * sizeof(net_client_t));
+        if (!tmp) {
+            perror("realloc");
+            close(sockfd);
+            return -1;
+        }
+        clients = tmp;
+        max_clients = new_max;
+    }
+    clients[num_clients++] = (net_client_t){.sockfd = sockfd, .open = 1, .received = 0, .close_after = -1};
+    STAT_ADD(connections, 1);
+    push_event(NET_EVENT_CONNECT, sockfd, NULL);
+    return 0;
+}
+
+static net_client_t *find_client(int sockfd) {
+    for (int i = 0; i < num_clients; i++) {
+        if (clients[i].sockfd == sockfd) return &clients[i];
+    }
+    return NULL;
+}
+
+static void remove_client(int sockfd) {
+    net_client_t *client = find_client(sockfd);
+    if (client != NULL) {
+        free(client->unsent);
+        *client = clients[--num_clients];
+    }
+    close(sockfd);
+}
+
+// Make a client socket non-blocking and close-on-exec
+static void set_client_flags(int client_fd) {
+    int flags = fcntl(client_fd, F_GETFL, 0); // Get current flags
+    if (flags != -1) {
+        if (fcntl(client_fd, F_SETFL, flags | O_NONBLOCK) == -1) {
+            perror("fcntl: set non-blocking");
+        }
+    }
+    // Set close-on-exec flag
+    int fdflags = fcntl(client_fd, F_GETFD, 0);
+    if (fdflags != -1) {
+        fcntl(client_fd, F_SETFD, fdflags | FD_CLOEXEC);
+    }
+}
+
+// Accept all pending connections
+static void accept_clients(void) {
+    int client_fd;
+    do {
+        client_fd = accept(listen_fd, NULL, NULL);
+        if (client_fd < 0) {
+            if (errno == EMFILE || errno == ENFILE) {
+                perror("accept: too many fds");
+                break;
+            }
+            if (errno == EINTR)        continue;   // interrupted -> retry
+            if (errno == ECONNABORTED) continue;   // aborted handshake -> next
+            if ((errno != EAGAIN) && (errno != EWOULDBLOCK)) {
+                perror("accept");
+            }
+            // No more clients to accept right now
+            break;
+        }
+        set_client_flags(client_fd);
+        DBG("[Scheduler] New client connected: fd=%d\n", client_fd);
+        PROBE1(accept, client_fd);
+        add_client(client_fd);
+    } while (client_fd >= 0);
+}
+
+// Read the available data of a client, pushing each complete message as an event
+static void read_client(net_client_t *client) {
+    while (client->open) {
+        ssize_t n = read(client->sockfd, (char *)&client->msg + client->received,
+                         sizeof(msg_t) - client->received);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return;   // No more data right now
+            perror("read");
+        }
+        if (n <= 0) {
+            DBG("Connection closed by remote host\n");
+            client->open = 0;
+            push_event(NET_EVENT_DISCONNECT, client->sockfd, NULL);
+            return;
+        }
+        client->received += (size_t)n;
+        if (client->received == sizeof(msg_t)) {
+            push_event(NET_EVENT_MESSAGE, client->sockfd, &client->msg);
+            client->received = 0;
+            STAT_ADD(messages_in, 1);
+        }
+    }
+}
+
+// Write as much as possible, returning the number of bytes written or -1 if the connection failed
+static ssize_t write_some(int sockfd, const char *data, size_t len) {
+    size_t written = 0;
+    while (written < len) {
+        ssize_t n = send(sockfd, data + written, len - written, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;  // Socket full, retry on POLLOUT
+            perror("write");
+            return -1;
+        }
+        written += (size_t)n;
+    }
+    return (ssize_t)written;
+}
+
+// Keep bytes that could not be written, after the ones already waiting
+static void keep_unsent(net_client_t *client, const char *data, size_t len) {
+    if (client->unsent_len + len > client->unsent_cap) {
+        size_t cap = client->unsent_cap ? client->unsent_cap * 2 : 4 * sizeof(msg_t);
+        while (cap < client->unsent_len + len) cap *= 2;
+        char *tmp = realloc(client->unsent, cap);
+        if (!tmp) {
+            perror("realloc");
+            return;
+        }
+        client->unsent = tmp;
+        client->unsent_cap = cap;
+    }
+    memcpy(client->unsent + client->unsent_len, data, len);
+    client->unsent_len += len;
+}
+
+// Close the connection, or pass it to the router, once everything was written
+static void finish_client(int sockfd, int type, const shard_task_t *task) {
+    if (type == NET_OUT_MIGRATE) {
+        shard_msg_t handoff = {.type = SHARD_CLIENT, .has_request = 1, .task = *task};
+        shard_send(ctl_fd, &handoff, sockfd);
+    }
+    remove_client(sockfd);
+}
+
+// Retry the bytes that did not fit in the socket (POLLOUT)
+static void write_unsent(net_client_t *client) {
+    ssize_t n = write_some(client->sockfd, client->unsent, client->unsent_len);
+    if (n < 0) {
+        client->unsent_len = 0;     // The connection failed, the messages are lost
+    } else {
+        memmove(client->unsent, client->unsent + n, client->unsent_len - (size_t)n);
+        client->unsent_len -= (size_t)n;
+    }
+    if (client->unsent_len == 0 && client->close_after >= 0) {
+        finish_client(client->sockfd, client->close_after, &client->migrate);
+    }
+}
+
+// Write the messages queued by the scheduling thread. A message that does not fit in
+// the socket is kept with its connection, so later messages, the close and the
+// migration wait for it.
+static void flush_out_queue(void) {
+    mpsc_node_t *node;
+    while ((node = mpsc_pop(&out_queue)) != NULL) {
+        net_out_t *out = (net_out_t *)node;
+        net_client_t *client = find_client(out->sockfd);
+        if (out->type == NET_OUT_MESSAGE) {
+            // Stamped just before the write, so the applications can measure the delivery delay
+            struct timespec ts;
+            clock_gettime(CLOCK_MONOTONIC, &ts);
+            out->msg.sent_ns = (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+            if (client != NULL && client->unsent_len > 0) {
+                keep_unsent(client, (const char *)&out->msg, sizeof(msg_t));
+                STAT_ADD(messages_out, 1);
+            } else {
+                ssize_t n = write_some(out->sockfd, (const char *)&out->msg, sizeof(msg_t));
+                if (n >= 0 && (size_t)n < sizeof(msg_t) && client != NULL) {
+                    keep_unsent(client, (const char *)&out->msg + n, sizeof(msg_t) - (size_t)n);
+                }
+                if (n >= 0) STAT_ADD(messages_out, 1);
+            }
+        } else if (client != NULL && client->unsent_len > 0) {
+            client->close_after = (int)out->type;
+            client->migrate = out->task;
+        } else {
+            finish_client(out->sockfd, (int)out->type, &out->task);
+        }
+        free(out);
+    }
+}
+
+// Give the unsent messages some time to be written before the connections are closed
+static void drain_unsent(void) {
+    uint64_t deadline_ms = now_ms() + NETIO_DRAIN_MS;
+    while (now_ms() < deadline_ms) {
+        int waiting = 0;
+        for (int i = num_clients - 1; i >= 0; i--) {
+            if (clients[i].unsent_len == 0) continue;
+            waiting = 1;
+            struct pollfd pfd = {.fd = clients[i].sockfd, .events = POLLOUT};
+            if (poll(&pfd, 1, NETIO_POLL_MS) > 0) write_unsent(&clients[i]);
+        }
+        if (!waiting) break;
+    }
+}
+
+// Handle a message of the router on the control socket of a shard
+static void read_control(void) {
+    static shard_msg_t msg;     // Large, and only used by the I/O thread
+    int fd;
+    int ret = shard_recv(ctl_fd, &msg, &fd);
+    if (ret <= 0) {
+        // The router is gone, stop the simulation like on Ctrl+C
+        close(ctl_fd);
+        ctl_fd = -1;
+        kill(getpid(), SIGTERM);
+        return;
+    }
+    if (msg.type == SHARD_CLIENT && fd >= 0) {
+        set_client_flags(fd);
+        DBG("[Scheduler] New client from the router: fd=%d\n", fd);
+        if (add_client(fd) == 0 && msg.has_request) {
+            push_migrate_event(fd, &msg.task);
+        }
+    } else if (msg.type == SHARD_RELEASE) {
+        msg_t release = {.time_ms = msg.count};
+        push_event(NET_EVENT_RELEASE, -1, &release);
+    } else if (fd >= 0) {
+        close(fd);
+    }
+}
+
+// Send the load and statistics of the shard to the router
+static void send_report(void) {
+    static shard_msg_t report;
+    report.type = SHARD_REPORT;
+    shard_snapshot(report.stats);
+    shard_send(ctl_fd, &report, -1);
+}
+
+static void *netio_thread(void *arg) {
+    (void)arg;
+    struct pollfd *fds = NULL;
+    int max_fds = 0;
+
+    uint64_t next_report_ms = 0;
+
+    while (atomic_load(&io_running)) {
+        flush_out_queue();
+        if (ctl_fd >= 0 && now_ms() >= next_report_ms) {
+            send_report();
+            next_report_ms = now_ms() + SHARD_REPORT_MS;
+        }
+
+        if (num_clients + 1 > max_fds) {
+            max_fds = max_clients + 1;
+            struct pollfd *tmp = realloc(fds, (size_t)max_fds * sizeof(struct pollfd));
+            if (!tmp) {
+                perror("realloc");
+                break;
+            }
+            fds = tmp;
+        }
+        int nfds = 0;
+        // A shard receives its connections on the control socket
+        fds[nfds++] = (struct pollfd){.fd = listen_fd >= 0 ? listen_fd : ctl_fd, .events = POLLIN};
+        for (int i = 0; i < num_clients; i++) {
+            // Closed connections are no longer read, but stay until netio_close()
+            short events = (short)((clients[i].open ? POLLIN : 0) | (clients[i].unsent_len > 0 ? POLLOUT : 0));
+            fds[nfds++] = (struct pollfd){.fd = events ? clients[i].sockfd : -1, .events = events};
+        }
+
+        int ready = poll(fds, (nfds_t)nfds, NETIO_POLL_MS);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            perror("poll");
+            break;
+        }
+        if (ready == 0) continue;
+
+        // Clients first, from the last one, because accepting and closing may reorder the table
+        for (int i = nfds - 1; i >= 1; i--) {
+            if (fds[i].fd < 0 || fds[i].revents == 0) continue;
+            if (fds[i].revents & (POLLIN | POLLHUP | POLLERR)) read_client(&clients[i - 1]);
+            if (clients[i - 1].unsent_len > 0 && (fds[i].revents & (POLLOUT | POLLERR | POLLHUP))) {
+                write_unsent(&clients[i - 1]);
+            }
+        }
+        if (fds[0].revents != 0) {
+            if (listen_fd >= 0) {
+                accept_clients();
+            } else if (ctl_fd >= 0) {
+                read_control();
+            }
+        }
+    }
+    flush_out_queue();
+    drain_unsent();
+    free(fds);
+    return NULL;
+}
+
+int netio_start(int server_fd) {
+    mpsc_init(&in_queue);
+    mpsc_init(&out_queue);
+    listen_fd = server_fd;
+    atomic_store(&io_running, 1);
+    int err = pthread_create(&io_thread, NULL, netio_thread, NULL);
+    if (err != 0) {
+        fprintf(stderr, "pthread_create: failed to start the I/O thread (%d)\n", err);
+        atomic_store(&io_running, 0);
+        return -1;
+    }
+    return 0;
+}
+
+int netio_start_shard(int control_fd) {
+    ctl_fd = control_fd;
+    return netio_start(-1);
+}
+
+int netio_start_loopback(const netio_loopback_t *lb) {
+    mpsc_init(&in_queue);
+    mpsc_init(&out_queue);
+    loopback = lb;
+    return 0;
+}
+
+void netio_inject(net_event_type_en type, int sockfd, const msg_t *msg) {
+    if (type == NET_EVENT_CONNECT) STAT_ADD(connections, 1);
+    if (type == NET_EVENT_MESSAGE) STAT_ADD(messages_in, 1);
+    push_event(type, sockfd, msg);
+}
+
+void netio_stop(void) {
+    if (loopback != NULL) {
+        loopback = NULL;
+    } else if (atomic_load(&io_running)) {
+        atomic_store(&io_running, 0);
+        pthread_join(io_thread, NULL);
+        for (int i = 0; i < num_clients; i++) {
+            close(clients[i].sockfd);
+            free(clients[i].unsent);
+        }
+        free(clients);
+        clients = NULL;
+        num_clients = max_clients = 0;
+    } else {
+        return;
+    }
+
+    mpsc_node_t *node;
+    while ((node = mpsc_pop(&in_queue)) != NULL) {
+        free(node);
+    }
+}
+
+net_event_t *netio_next_event(void) {
+    return (net_event_t *)mpsc_pop(&in_queue);
+}
+
+void netio_send(int sockfd, const msg_t *msg) {
+    if (loopback != NULL) {
+        STAT_ADD(messages_out, 1);
+        loopback->send(sockfd, msg);
+        return;
+    }
+    push_out(NET_OUT_MESSAGE, sockfd, msg);
+}
+
+void netio_migrate(int sockfd, const shard_task_t *task) {
+    net_out_t *out = malloc(sizeof(net_out_t));
+    if (!out) {
+        perror("malloc");
+        return;
+    }
+    out->type = NET_OUT_MIGRATE;
+    out->sockfd = sockfd;
+    out->task = *task;
+    mpsc_push(&out_queue, &out->node);
+}
+
+void netio_close(int sockfd) {
+    if (loopback != NULL) {
+        loopback->close(sockfd);
+        return;
+    }
+    push_out(NET_OUT_CLOSE, sockfd, NULL);
+}
+
+void netio_checkpoint(checkpoint_t *ck) {
+    ckpt_event_queue(ck, &in_queue);
+}
@@ -0,0 +1,129 @@
+#ifndef NETIO_H
+#define NETIO_H
+
+#include "checkpoint.h"
+#include "mpsc.h"
+#include "msg.h"
+#include "shard.h"
+
+/*
+ * Network I/O of the simulator.
+ * A dedicated thread accepts the connections of the applications and reads their
+ * messages, and pushes them as events to a lock-free queue consumed by the
+ * scheduling thread. The messages sent by the scheduling thread (ACK/DONE) go
+ * through a second queue and are written by the I/O thread, so the scheduling
+ * thread never blocks on a socket.
+ */
+
+typedef enum {
+    NET_EVENT_CONNECT = 0,  // A new application connected
+    NET_EVENT_MESSAGE,      // A message was received from an application
+    NET_EVENT_DISCONNECT,   // An application closed the connection
+    NET_EVENT_MIGRATE_IN,   // A task moved from another shard, msg is its RUN request (already acknowledged)
+    NET_EVENT_RELEASE,      // The router asks for waiting tasks to move to another shard (count in msg.time_ms)
+} net_event_type_en;
+
+typedef struct {
+    mpsc_node_t node;       // Must be the first field
+    net_event_type_en type;
+    int sockfd;             // Socket of the application (identifies the connection)
+    msg_t msg;              // Received message (NET_EVENT_MESSAGE and NET_EVENT_MIGRATE_IN only)
+    uint32_t client_time_ms;// NET_EVENT_MIGRATE_IN: time of the application's clock (see shard_task_t)
+    uint32_t waited_ms;     // NET_EVENT_MIGRATE_IN: time the request already waited in the other shard
+} net_event_t;
+
+/**
+ * @brief Start the I/O thread
+ *
+ * @param server_fd The (non-blocking) listening socket
+ * @return 0 on success, -1 on failure
+ */
+int netio_start(int server_fd);
+
+/**
+ * @brief Start the I/O thread of a shard (see shard.h)
+ *
+ * Instead of accepting connections, the I/O thread receives them from the router
+ * on the control socket, and reports the load and statistics of the shard on it
+ * every SHARD_REPORT_MS. When the router closes the control socket, the process
+ * receives SIGTERM.
+ *
+ * @param ctl_fd The control socket
+ * @return 0 on success, -1 on failure
+ */
+int netio_start_shard(int ctl_fd);
+
+// Callbacks that receive the messages sent by the scheduling thread in loopback mode
+typedef struct {
+    void (*send)(int sockfd, const msg_t *msg);
+    void (*close)(int sockfd);
+} netio_loopback_t;
+
+/**
+ * @brief Start in loopback mode, without sockets nor I/O thread
+ *
+ * The events are injected with netio_inject() and the messages sent by the
+ * scheduling thread are passed to the callbacks, in the scheduling thread.
+ *
+ * @param loopback The callbacks (must stay valid until netio_stop())
+ * @return 0 on success
+ */
+int netio_start_loopback(const netio_loopback_t *loopback);
+
+/**
+ * @brief Inject an event, as if it was received from an application (loopback mode only)
+ *
+ * @param type   The type of the event
+ * @param sockfd The connection of the application
+ * @param msg    The received message (NET_EVENT_MESSAGE only, NULL otherwise)
+ */
+void netio_inject(net_event_type_en type, int sockfd, const msg_t *msg);
+
+/**
+ * @brief Stop the I/O thread, after it has written the pending messages
+ */
+void netio_stop(void);
+
+/**
+ * @brief Get the next event received by the I/O thread (scheduling thread only)
+ *
+ * @return The event, to be released with free(), or NULL if there are no events
+ */
+net_event_t *netio_next_event(void);
+
+/**
+ * @brief Send a message to an application
+ *
+ * The message is queued and written by the I/O thread.
+ *
+ * @param sockfd The socket of the application
+ * @param msg    The message to send
+ */
+void netio_send(int sockfd, const msg_t *msg);
+
+/**
+ * @brief Close the connection of an application, after its pending messages are written
+ *
+ * @param sockfd The socket of the application
+ */
+void netio_close(int sockfd);
+
+/**
+ * @brief Give a task back to the router, to move it to another shard
+ *
+ * The connection is passed to the router with the RUN request in progress, and
+ * closed in this shard once the pending messages are written.
+ *
+ * @param sockfd The socket of the application
+ * @param task   The RUN request, with the CPU time the task still needs, and its clock
+ */
+void netio_migrate(int sockfd, const shard_task_t *task);
+
+/**
+ * @brief Save or restore the events not yet consumed by the scheduling thread (loopback mode only)
+ *
+ * @param ck The checkpoint
+ */
+void netio_checkpoint(checkpoint_t *ck);
+
+#endif // NETIO_H
@@ -8,21 +8,47 @@
 #include "debug.h"
 
 #define MAX_CLIENTS 128
-#define NUM_CPUS 4
 
 #include <stdlib.h>
+#include <signal.h>
 #include <sys/errno.h>
 
+#include "checkpoint.h"
+#include "cpu.h"
+#include "easy.h"
+#include "emulate.h"
 #include "fifo.h"
+#include "fair.h"
+#include "gang.h"
+#include "group.h"
+#include "hotplug.h"
+#include "iodev.h"
+#include "metrics.h"
 #include "mlfq.h"
 #include "sjf.h"
 
 #include "msg.h"
+#include "netio.h"
+#include "params.h"
+#include "phase.h"
+#include "power.h"
+#include "probes.h"
 #include "queue.h"
+#include "replay.h"
 #include "rr.h"
+#include "stats.h"
+#include "tasktab.h"
 
 static uint32_t PID = 0;
 
+// Cleared by SIGINT/SIGTERM to stop the simulation and print the statistics
+static volatile sig_atomic_t running = 1;
+
+static void handle_stop_signal(int signum) {
+    (void)signum;
+    running = 0;
+}
+
 
 
 /**
@@ -50,7 +76,7 @@ int setup_server_socket(const char *socket_path) {
 
     memset(&addr, 0, sizeof(struct sockaddr_un));
     addr.sun_family = AF_UNIX;
-    strncpy(addr.sun_path, SOCKET_PATH, sizeof(addr.sun_path) - 1);
+    strncpy(addr.sun_path, socket_path, sizeof(addr.sun_path) - 1);
 
     // Bind
     if (bind(server_fd, (struct sockaddr *) &addr, sizeof(struct sockaddr_un)) < 0) {
@@ -75,171 +101,233 @@ int setup_server_socket(const char *socket_path) {
     return server_fd;
 }
 
+// Events received for a task that was not in the command queue yet, retried on the next check
+static mpsc_queue_t deferred_events;
+static int num_deferred_events = 0;
+
+// Find the element of the command queue with the pcb of a connection
+static queue_elem_t *find_command_elem(queue_t *command_queue, int sockfd) {
+    for (queue_elem_t *elem = command_queue->head; elem != NULL; elem = elem->next) {
+        if ((int)elem->pcb->sockfd == sockfd) return elem;
+    }
+    return NULL;
+}
+
 /**
- * @brief Check for new client connections and add them to the queue.
+ * @brief Give waiting tasks back to the router, to move them to another shard.
  *
- * This function accepts new client connections on the server socket,
- * sets the client sockets to non-blocking mode, and enqueues them
- * into the provided queue.
+ * The tasks at the end of the ready queue, which would wait the longest in this
+ * shard, are passed to the router with a RUN request for the CPU time they still
+ * need. Parallel tasks are kept, they must be placed on all their CPUs at once.
+ * The task also brings the time of its application's clock, so the new shard
+ * keeps sending the ACK/DONE times on the clock the application started with.
  *
- * @param command_queue The queue to which new pcb will be added
- * @param server_fd The server socket file descriptor
+ * @param ready_queue     The ready queue
+ * @param count           The number of tasks to give back
+ * @param current_time_ms The current time in milliseconds
  */
-void check_new_commands(queue_t *command_queue, queue_t *blocked_queue, queue_t *ready_queue, int server_fd, uint32_t current_time_ms) {
-    // Accept new client connections
-    int client_fd;
-    do {
-        client_fd = accept(server_fd, NULL, NULL);
-        if (client_fd < 0) {
-            if (errno == EMFILE || errno == ENFILE) {
-                perror("accept: too many fds");
-                break;
-            }
-            if (errno == EINTR)        continue;   // interrupted -> retry
-            if (errno == ECONNABORTED) continue;   // aborted handshake -> next
-            if ((errno != EAGAIN) && (errno != EWOULDBLOCK)) {
-                perror("accept");
-            }
-            // No more clients to accept right now
-            break;
-        }
-        int flags = fcntl(client_fd, F_GETFL, 0); // Get current flags
-        if (flags != -1) {
-            if (fcntl(client_fd, F_SETFL, flags | O_NONBLOCK) == -1) {
-                perror("fcntl: set non-blocking");
-            }
-        }
-        // Set close-on-exec flag
-        int fdflags = fcntl(client_fd, F_GETFD, 0);
-        if (fdflags != -1) {
-            fcntl(client_fd, F_SETFD, fdflags | FD_CLOEXEC);
+static void release_tasks(queue_t *ready_queue, uint32_t count, uint32_t current_time_ms) {
+    int skip = ready_queue->size - (int)count;
+    queue_elem_t *elem = ready_queue->head;
+    while (elem != NULL) {
+        queue_elem_t *next = elem->next;
+        pcb_t *pcb = elem->pcb;
+        if (skip-- > 0 || pcb->parallelism > 1) {
+            elem = next;
+            continue;
         }
-        DBG("[Scheduler] New client connected: fd=%d\n", client_fd);
+        // The new shard continues the application's clock, and the response time of the request
+        shard_task_t task = {
+            .request = {
+                .pid = pcb->pid,
+                .request = PROCESS_REQUEST_RUN,
+                .time_ms = cpu_remaining_ms(pcb),
+                .parallelism = 1
+            },
+            .client_time_ms = current_time_ms - pcb->clock_offset_ms,
+            .waited_ms = current_time_ms - pcb->request_ms,
+        };
+        memcpy(task.request.group, group_get(pcb->group)->name, sizeof(task.request.group));
+        remove_queue_elem(ready_queue, elem);
+        free(elem);
+        mlfq_forget(pcb->pid);
+        emulate_forget(pcb->pid);
+        group_leave(pcb);
+        netio_migrate((int)pcb->sockfd, &task);
+        DBG("Process %d moved to another shard with %u ms left\n", pcb->pid, task.request.time_ms);
+        free(pcb);
+        elem = next;
+    }
+}
+
+/**
+ * @brief Handle one event received from the I/O thread.
+ *
+ * @return 0 if the event was handled, -1 if it must be retried later
+ */
+static int handle_event(const net_event_t *event, queue_t *command_queue, queue_t *ready_queue, uint32_t current_time_ms) {
+    if (event->type == NET_EVENT_CONNECT) {
         // New PCBs do not have a time yet, will be set when we receive a RUN message
-        pcb_t *pcb = new_pcb(++PID, client_fd, 0);
+        pcb_t *pcb = new_pcb(++PID, event->sockfd, 0);
         enqueue_pcb(command_queue, pcb);
-    } while (client_fd > 0);
+        return 0;
+    }
+    if (event->type == NET_EVENT_RELEASE) {
+        release_tasks(ready_queue, event->msg.time_ms, current_time_ms);
+        return 0;
+    }
 
-    // Check queue for new commands in the command queue
-    queue_elem_t * elem = command_queue->head;
-    while (elem != NULL) {
-        pcb_t *current_pcb = elem->pcb;
-        msg_t msg;
-        int n = read(current_pcb->sockfd, &msg, sizeof(msg_t));
-        if (n <= 0) {
-            if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                // No data available right now, move to next
-                elem = elem->next;
-            } else {
-                if (n < 0) {
-                    perror("read");
-                } else {
-                    DBG("Connection closed by remote host\n");
-                }
-                // Remove from queue
-                queue_elem_t *tmp = elem;
-                elem = elem->next;
-                free(current_pcb);
-                free(tmp);
-            }
-            continue;
-        }
-        // We have received a message
-        if (msg.request == PROCESS_REQUEST_RUN) {
-            current_pcb->pid = msg.pid; // Set the pid from the message
-            current_pcb->time_ms = msg.time_ms;
-            current_pcb->ellapsed_time_ms = 0;
-            current_pcb->status = TASK_RUNNING;
-            enqueue_pcb(ready_queue, current_pcb);
-            DBG("Process %d requested RUN for %d ms\n", current_pcb->pid, current_pcb->time_ms);
-        } else if (msg.request == PROCESS_REQUEST_BLOCK) {
-            current_pcb->pid = msg.pid; // Set the pid from the message
-            current_pcb->time_ms = msg.time_ms;
-            current_pcb->status = TASK_BLOCKED;
-            enqueue_pcb(blocked_queue, current_pcb);
-            DBG("Process %d requested BLOCK for %d ms\n", current_pcb->pid);
-        } else {
-            printf("Unexpected message received from client\n");
-            continue;
-        }
-        // Remove from command queue
+    queue_elem_t *elem = find_command_elem(command_queue, event->sockfd);
+    if (elem == NULL) {
+        // The task is still running or blocked, wait until it is back in the command queue
+        return -1;
+    }
+    pcb_t *current_pcb = elem->pcb;
+
+    if (event->type == NET_EVENT_DISCONNECT) {
         remove_queue_elem(command_queue, elem);
-        queue_elem_t *tmp = elem;
-        elem = elem->next;
-        free(tmp);
-
-        // Send ack message
-        msg_t ack_msg = {
-            .pid = current_pcb->pid,
-            .request = PROCESS_REQUEST_ACK,
-            .time_ms = current_time_ms
-        };
-        if (write(current_pcb->sockfd, &ack_msg, sizeof(msg_t)) != sizeof(msg_t)) {
-            perror("write");
-        }
-        DBG("Send ACK message to process %d with time %d\n", current_pcb->pid, current_time_ms);
+        free(elem);
+        // The I/O boost of a last BLOCK request is never used, nor the working sets of the emulation
+        mlfq_forget(current_pcb->pid);
+        emulate_forget(current_pcb->pid);
+        group_leave(current_pcb);
+        netio_close(event->sockfd);
+        free(current_pcb);
+        return 0;
     }
 
+    // We have received a message
+    // A task moved from another shard was already acknowledged there
+    const msg_t *msg = &event->msg;
+    int send_ack = (event->type == NET_EVENT_MESSAGE);
+    if (msg->request == PROCESS_REQUEST_RUN) {
+        current_pcb->pid = msg->pid; // Set the pid from the message
+        current_pcb->time_ms = msg->time_ms;
+        current_pcb->ellapsed_time_ms = 0;
+        current_pcb->parallelism = (msg->parallelism > 1) ? msg->parallelism : 1;
+        current_pcb->burst_ms = msg->time_ms;
+        current_pcb->burst_run_ms = 0;
+        group_join(current_pcb, msg->group);
+        current_pcb->request_ms = current_time_ms;
+        if (event->type == NET_EVENT_MIGRATE_IN) {
+            current_pcb->clock_offset_ms = current_time_ms - event->client_time_ms;
+            current_pcb->request_ms = (event->waited_ms < current_time_ms) ? current_time_ms - event->waited_ms : 0;
+        }
+        current_pcb->status = TASK_RUNNING;
+        enqueue_pcb(ready_queue, current_pcb);
+        PROBE3(request_run, current_pcb->pid, current_pcb->time_ms, current_time_ms);
+        DBG("Process %d requested RUN for %d ms\n", current_pcb->pid, current_pcb->time_ms);
+    } else if (msg->request == PROCESS_REQUEST_BLOCK) {
+        current_pcb->pid = msg->pid; // Set the pid from the message
+        current_pcb->time_ms = msg->time_ms;
+        group_join(current_pcb, msg->group);
+        current_pcb->status = TASK_BLOCKED;
+        io_submit(current_pcb, msg->device, msg->position, current_time_ms);
+        PROBE3(request_block, current_pcb->pid, current_pcb->time_ms, current_time_ms);
+        DBG("Process %d requested BLOCK for %d ms\n", current_pcb->pid, current_pcb->time_ms);
+    } else {
+        printf("Unexpected message received from client\n");
+        return 0;
+    }
+    // Remove from command queue
+    remove_queue_elem(command_queue, elem);
+    free(elem);
+
+    if (!send_ack) return 0;
+
+    // Send ack message
+    msg_t ack_msg = {
+        .pid = current_pcb->pid,
+        .request = PROCESS_REQUEST_ACK,
+        .time_ms = current_time_ms - current_pcb->clock_offset_ms
+    };
+    netio_send(current_pcb->sockfd, &ack_msg);
+    DBG("Send ACK message to process %d with time %d\n", current_pcb->pid, current_time_ms);
+    return 0;
 }
 
 /**
- * @brief Check the blocked queue for messages from clients.
+ * @brief Handle the new connections and commands received by the I/O thread.
  *
- * This function iterates through the blocked queue, checking each client
- * socket for incoming messages. If a RUN message is received, the corresponding
- * pcb is moved to the command queue and an ACK message is sent back to the client.
- * If a client disconnects or an error occurs, the client is removed from the blocked queue.
+ * The I/O thread accepts the connections and reads the messages of the clients.
+ * This function consumes those events: new connections get a pcb in the command
+ * queue, RUN/BLOCK requests move the pcb to the ready queue or to an I/O device
+ * and are acknowledged, and closed connections are removed.
  *
- * @param blocked_queue The queue containing PCBs in I/O wait stated (blocked) from CPU
- * @param command_queue The queue where PCBs ready for new instructions will be moved
+ * @param command_queue The queue to which new pcb will be added
+ * @param ready_queue The queue where PCBs that requested the CPU will be added
  * @param current_time_ms The current time in milliseconds
  */
-void check_blocked_queue(queue_t * blocked_queue, queue_t * command_queue, uint32_t current_time_ms) {
-    // Check all elements of the blocked queue for new messages
-    queue_elem_t * elem = blocked_queue->head;
-    while (elem != NULL) {
-        pcb_t *pcb = elem->pcb;
-
-        // Make sure the time is updated only once per cycle
-        if (pcb->last_update_time_ms < current_time_ms) {
-            if (pcb->time_ms > TICKS_MS) {
-                pcb->time_ms -= TICKS_MS;
-            } else {
-                pcb->time_ms = 0;
-            }
+void check_new_commands(queue_t *command_queue, queue_t *ready_queue, uint32_t current_time_ms) {
+    net_event_t *event;
+
+    // Retry the events that could not be handled before, in the order they arrived
+    int retries = num_deferred_events;
+    num_deferred_events = 0;
+    while (retries-- > 0 && (event = (net_event_t *)mpsc_pop(&deferred_events)) != NULL) {
+        if (handle_event(event, command_queue, ready_queue, current_time_ms) == 0) {
+            free(event);
+        } else {
+            mpsc_push(&deferred_events, &event->node);
+            num_deferred_events++;
         }
+    }
 
-        if (pcb->time_ms == 0) {
-            // Send DONE message to the application
-            msg_t msg = {
-                .pid = pcb->pid,
-                .request = PROCESS_REQUEST_DONE,
-                .time_ms = current_time_ms
-            };
-            if (write(pcb->sockfd, &msg, sizeof(msg_t)) != sizeof(msg_t)) {
-                perror("write");
-            }
-            DBG("Process %d finished BLOCK, sending DONE\n", pcb->pid);
-            pcb->status = TASK_COMMAND;
-            pcb->last_update_time_ms = current_time_ms;
-            enqueue_pcb(command_queue, pcb);
-
-            // Remove from blocked queue
-            remove_queue_elem(blocked_queue, elem);
-            queue_elem_t *tmp = elem;
-            elem = elem->next;  // Do this here, because we free it in the next line
-            free(tmp);
+    while ((event = netio_next_event()) != NULL) {
+        if (handle_event(event, command_queue, ready_queue, current_time_ms) == 0) {
+            free(event);
         } else {
-            elem = elem->next;  // If not done already, do it now
+            mpsc_push(&deferred_events, &event->node);
+            num_deferred_events++;
         }
     }
 }
 
+/**
+ * @brief Check the blocked queue for messages from clients.
+ *
+ * The blocked queue holds the I/O requests being served by a device channel, in a
+ * table of timers (see tasktab.h) that is counted down by one tick. When a request
+ * finishes, its device channel is released, a DONE message is sent to the client
+ * and the pcb is moved to the command queue.
+ *
+ * @param blocked_tasks The table containing PCBs in I/O wait stated (blocked) from CPU
+ * @param command_queue The queue where PCBs ready for new instructions will be moved
+ * @param current_time_ms The current time in milliseconds
+ */
+void check_blocked_queue(task_table_t *blocked_tasks, queue_t * command_queue, uint32_t current_time_ms) {
+    // The requests were started in previous ticks, so all of them advance
+    int num_expired = task_table_tick(blocked_tasks, TICKS_MS);
+    for (int i = 0; i < num_expired; i++) {
+        pcb_t *pcb = blocked_tasks->expired[i];
+        PROBE2(block_expired, pcb->pid, current_time_ms);
+        // Send DONE message to the application
+        msg_t msg = {
+            .pid = pcb->pid,
+            .request = PROCESS_REQUEST_DONE,
+            .time_ms = current_time_ms - pcb->clock_offset_ms
+        };
+        netio_send(pcb->sockfd, &msg);
+        PROBE3(done_sent, pcb->pid, 1, current_time_ms);
+        DBG("Process %d finished BLOCK, sending DONE\n", pcb->pid);
+        io_complete(pcb);
+        mlfq_io_boost(pcb->pid);
+        pcb->status = TASK_COMMAND;
+        pcb->last_update_time_ms = current_time_ms;
+        enqueue_pcb(command_queue, pcb);
+    }
+}
+
 static const char *SCHEDULER_NAMES[] = {
     "FIFO",
     "SJF",
     "RR",
     "MLFQ",
+    "GANG",
+    "SJF-EXP",
+    "FAIR",
+    "EASY",
+    "RR-ADAPT",
     NULL
 };
 
@@ -248,7 +336,12 @@ typedef enum  {
     SCHED_FIFO = 0,
     SCHED_SJF = 1,
     SCHED_RR = 2,
-    SCHED_MLFQ = 3
+    SCHED_MLFQ = 3,
+    SCHED_GANG = 4,
+    SCHED_SJF_EXP = 5,
+    SCHED_FAIR = 6,
+    SCHED_EASY = 7,
+    SCHED_RR_ADAPT = 8
 } scheduler_en;
 
 scheduler_en get_scheduler(const char *name) {
@@ -264,73 +357,336 @@ scheduler_en get_scheduler(const char *name) {
     return NULL_SCHEDULER;
 }
 
+static void print_usage(const char *prog) {
+    printf("Usage: %s [-p name=value]... [-d name:channels[:FIFO|SHORTEST|ELEVATOR]]... "
+           "[-t sockets:cores:threads] [-c capacity,...] [-g performance|powersave|ondemand|schedutil] "
+           "[-w group=weight]... [-H hotplug_schedule] [-r scenario.sh [-o report] [-s time_ms:checkpoint] [-l checkpoint]] [-x control_fd] <scheduler>\n"
+           "Scheduler options:", prog);
+    for (int i = 0; SCHEDULER_NAMES[i] != NULL; i++) {
+        printf(" %s", SCHEDULER_NAMES[i]);
+    }
+    printf("\nParameters:\n");
+    params_print(stdout);
+}
+
 int main(int argc, char *argv[]) {
-    if (argc != 2) {
-        printf("Usage: %s <scheduler>\nScheduler options: FIFO", argv[0]);
+    // Parse arguments
+    const char *scenario_path = NULL;   // Replay a scenario instead of serving sockets
+    const char *report_path = NULL;
+    const char *save_path = NULL;       // Checkpoint to save when the simulation reaches save_at_ms
+    uint32_t save_at_ms = 0;
+    const char *restore_path = NULL;    // Checkpoint to continue from
+    int ctl_fd = -1;                    // Control socket when started by the router as a shard
+    const char *hotplug_path = NULL;    // Changes of the online CPUs over time
+    int opt;
+    while ((opt = getopt(argc, argv, "p:d:t:c:g:w:H:r:o:s:l:x:")) != -1) {
+        switch (opt) {
+            case 'p':
+                if (params_set(optarg) != 0) {
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            case 'd':
+                if (io_add_device(optarg) != 0) {
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            case 't':
+                if (topo_configure(optarg) != 0) {
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            case 'c':
+                if (topo_set_capacities(optarg) != 0) {
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            case 'g':
+                if (power_set_governor(optarg) != 0) {
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            case 'w':
+                if (group_set_weight(optarg) != 0) {
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            case 'H':
+                hotplug_path = optarg;
+                break;
+            case 'r':
+                scenario_path = optarg;
+                break;
+            case 'o':
+                report_path = optarg;
+                break;
+            case 's': {
+                char *endptr;
+                unsigned long ms = strtoul(optarg, &endptr, 10);
+                if (endptr == optarg || *endptr != ':' || endptr[1] == '\0' || ms > UINT32_MAX) {
+                    fprintf(stderr, "Invalid checkpoint %s, expected time_ms:path\n", optarg);
+                    exit(EXIT_FAILURE);
+                }
+                save_at_ms = (uint32_t)ms;
+                save_path = endptr + 1;
+                break;
+            }
+            case 'l':
+                restore_path = optarg;
+                break;
+            case 'x':
+                ctl_fd = atoi(optarg);
+                break;
+            default:
+                print_usage(argv[0]);
+                exit(EXIT_FAILURE);
+        }
+    }
+    if (optind != argc - 1) {
+        print_usage(argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    if (ctl_fd >= 0 && scenario_path != NULL) {
+        fprintf(stderr, "A shard cannot replay a scenario\n");
+        exit(EXIT_FAILURE);
+    }
+    if ((save_path != NULL || restore_path != NULL) && scenario_path == NULL) {
+        // The connections of real applications cannot be saved
+        fprintf(stderr, "Checkpoints are only available when replaying a scenario (-r)\n");
         exit(EXIT_FAILURE);
     }
 
-    // Parse arguments
-    scheduler_en scheduler_type = get_scheduler(argv[1]);
+    // After -t, which sets the number of CPUs
+    if (hotplug_path != NULL && hotplug_load(hotplug_path) != 0) {
+        exit(EXIT_FAILURE);
+    }
+
+    const char *scheduler_name = argv[optind];
+    scheduler_en scheduler_type = get_scheduler(scheduler_name);
     if (scheduler_type == NULL_SCHEDULER) {
         return EXIT_FAILURE;
     }
 
+    io_init();
+
+    struct sigaction sa = {0};
+    sa.sa_handler = handle_stop_signal;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    PHASE_INIT();
+
     // We set up 3 queues: 1 for the simulator and 2 for scheduling
     // - COMMAND queue: for PCBs that are waiting for (new) instructions from the app
     // - READY queue: for PCBs that are ready to run on the CPU
-    // - BLOCKED queue: for PCBs that are blocked waiting for I/O
+    // - BLOCKED queue: for PCBs that are blocked waiting for I/O (a table of timers)
     queue_t command_queue = {.head = NULL, .tail = NULL};
     queue_t ready_queue = {.head = NULL, .tail = NULL};
-    queue_t blocked_queue = {.head = NULL, .tail = NULL};
+    task_table_t blocked_tasks;
+    task_table_init(&blocked_tasks);
 
     // Array de CPUs - cada posição pode ter um processo rodando ou NULL
-    pcb_t *cpus[NUM_CPUS] = { NULL };
-
-    int server_fd = setup_server_socket(SOCKET_PATH);
-    if (server_fd < 0) {
-        fprintf(stderr, "Failed to set up server socket\n");
-        return 1;
+    // Only the first num_cpus CPUs are online (see hotplug.h)
+    pcb_t *cpus[MAX_CPUS] = { NULL };
+    int num_cpus = topo_num_cpus();
+
+    int server_fd = -1;
+    int stats_fd = -1;
+    mpsc_init(&deferred_events);
+    if (scenario_path != NULL) {
+        // Socket-free replay in virtual time
+        if (replay_load(scenario_path) != 0 || replay_start() != 0) {
+            return EXIT_FAILURE;
+        }
+    } else if (ctl_fd >= 0) {
+        // The router accepts the connections and serves the metrics of all the shards
+        if (netio_start_shard(ctl_fd) != 0) {
+            return 1;
+        }
+        printf("Shard with %d CPUs receiving connections on fd %d...\n", num_cpus, ctl_fd);
+    } else {
+        server_fd = setup_server_socket(SOCKET_PATH);
+        if (server_fd < 0) {
+            fprintf(stderr, "Failed to set up server socket\n");
+            return 1;
+        }
+        if (netio_start(server_fd) != 0) {
+            close(server_fd);
+            return 1;
+        }
+        printf("Scheduler server listening on %s...\n", SOCKET_PATH);
+
+        stats_fd = setup_server_socket(STATS_SOCKET_PATH);
+        metrics_set_cpus_handler(hotplug_request);
+        if (stats_fd < 0 || metrics_start(stats_fd) != 0) {
+            fprintf(stderr, "Failed to set up the metrics socket, continuing without it\n");
+            if (stats_fd >= 0) close(stats_fd);
+            stats_fd = -1;
+        } else {
+            printf("Metrics available on %s\n", STATS_SOCKET_PATH);
+        }
+    }
+    if (sim_params.emulate && emulate_start(num_cpus) != 0) {
+        fprintf(stderr, "Failed to start the emulation\n");
+        return EXIT_FAILURE;
     }
-    printf("Scheduler server listening on %s...\n", SOCKET_PATH);
     uint32_t current_time_ms = 0;
-    while (1) {
+    sim_state_t state = {
+        .current_time_ms = &current_time_ms,
+        .next_pid = &PID,
+        .command_queue = &command_queue,
+        .ready_queue = &ready_queue,
+        .blocked_tasks = &blocked_tasks,
+        .cpus = cpus,
+        .num_cpus = num_cpus,
+        .deferred_events = &deferred_events,
+        .num_deferred_events = &num_deferred_events,
+    };
+    if (restore_path != NULL) {
+        if (checkpoint_restore(restore_path, &state) != 0) {
+            fprintf(stderr, "Failed to restore checkpoint %s\n", restore_path);
+            return EXIT_FAILURE;
+        }
+        printf("Restored checkpoint %s at %u ms\n", restore_path, current_time_ms);
+        num_cpus = hotplug_online_cpus();
+    }
+    while (running && !(scenario_path != NULL && replay_done())) {
+        if (scenario_path != NULL) {
+            // A task that is never scheduled would keep the replay running forever
+            if (sim_params.replay_max_ms > 0 && current_time_ms >= sim_params.replay_max_ms) {
+                fprintf(stderr, "The scenario did not finish in %u ms (replay_max_ms), stopping\n",
+                        sim_params.replay_max_ms);
+                break;
+            }
+            replay_tick(current_time_ms);
+        }
         // Check for new connections and/or instructions
-        check_new_commands(&command_queue, &blocked_queue, &ready_queue, server_fd, current_time_ms);
+        PHASE_BEGIN(PHASE_COMMANDS);
+        check_new_commands(&command_queue, &ready_queue, current_time_ms);
+        PHASE_END(PHASE_COMMANDS);
 
         if (current_time_ms%1000 == 0) {
             printf("Current time: %d s\n", current_time_ms/1000);
         }
         // Check the status of the PCBs in the blocked queue
-        check_blocked_queue(&blocked_queue, &command_queue, current_time_ms);
+        PHASE_BEGIN(PHASE_BLOCKED);
+        check_blocked_queue(&blocked_tasks, &command_queue, current_time_ms);
+        PHASE_END(PHASE_BLOCKED);
+        // Requests waiting for an I/O device can use the channels released above
+        io_start_requests(&blocked_tasks, current_time_ms);
         // Tasks from the blocked queue could be moved to the command queue, check again
-        usleep(TICKS_MS * 1000/2);
-        check_new_commands(&command_queue, &blocked_queue, &ready_queue, server_fd, current_time_ms);
+        if (scenario_path == NULL) usleep(TICKS_MS * 1000/2);
+        PHASE_BEGIN(PHASE_COMMANDS_AGAIN);
+        check_new_commands(&command_queue, &ready_queue, current_time_ms);
+        PHASE_END(PHASE_COMMANDS_AGAIN);
+
+        // CPUs going online or offline; the tasks of the CPUs going offline return to the READY queue
+        num_cpus = hotplug_tick(current_time_ms, cpus, num_cpus, &ready_queue);
 
         // The scheduler handles the READY queue
+        PHASE_BEGIN(PHASE_SCHEDULER);
         switch (scheduler_type) {
             case SCHED_FIFO:
-                fifo_scheduler(current_time_ms, &ready_queue, cpus, NUM_CPUS);
+                fifo_scheduler(current_time_ms, &ready_queue, cpus, num_cpus);
                 break;
             case SCHED_SJF:
-                sjf_scheduler(current_time_ms, &ready_queue, cpus, NUM_CPUS);
+                sjf_scheduler(current_time_ms, &ready_queue, cpus, num_cpus);
                 break;
             case SCHED_RR:
-                rr_scheduler(current_time_ms, &ready_queue, cpus, NUM_CPUS);
+                rr_scheduler(current_time_ms, &ready_queue, cpus, num_cpus);
                 break;
             case SCHED_MLFQ:
-                mlfq_scheduler(current_time_ms, &ready_queue, cpus, NUM_CPUS);
+                mlfq_scheduler(current_time_ms, &ready_queue, cpus, num_cpus);
+                break;
+            case SCHED_GANG:
+                gang_scheduler(current_time_ms, &ready_queue, cpus, num_cpus);
+                break;
+            case SCHED_SJF_EXP:
+                sjf_exp_scheduler(current_time_ms, &ready_queue, cpus, num_cpus);
+                break;
+            case SCHED_FAIR:
+                fair_scheduler(current_time_ms, &ready_queue, cpus, num_cpus);
+                break;
+            case SCHED_EASY:
+                easy_scheduler(current_time_ms, &ready_queue, cpus, num_cpus);
+                break;
+            case SCHED_RR_ADAPT:
+                rr_adapt_scheduler(current_time_ms, &ready_queue, cpus, num_cpus);
                 break;
             default:
                 printf("Unknown scheduler type\n");
                 break;
         }
-
-        // Simulate a tick
-        usleep(TICKS_MS * 1000/2);
+        PHASE_END(PHASE_SCHEDULER);
+        // Move running tasks between big and little cores
+        cpu_rebalance(cpus, num_cpus, current_time_ms);
+        // Tasks that finished their CPU burst wait for the next request from the app
+        cpu_collect_finished(&command_queue);
+        // The real work of this tick runs while the tick is accounted and, live, while we sleep
+        emulate_tick();
+        cpu_account_tick(cpus, num_cpus);
+        group_account_tick(&ready_queue, cpus, num_cpus);
+        power_account_tick(cpus, num_cpus);
+        io_account_tick();
+
+        // Publish the gauges for the metrics endpoint
+        STAT_SET(sim_time_ms, current_time_ms);
+        STAT_SET(command_queue_len, command_queue.size);
+        STAT_SET(ready_queue_len, ready_queue.size);
+        STAT_SET(blocked_queue_len, task_table_size(&blocked_tasks));
+        STAT_SET(io_wait_queue_len, io_waiting_count());
+        int busy_cpus = 0;
+        for (int i = 0; i < num_cpus; i++) busy_cpus += (cpus[i] != NULL);
+        STAT_SET(busy_cpus, busy_cpus);
+        hotplug_account_tick(current_time_ms, cpus, num_cpus, &ready_queue);
+
+        PHASE_POLL(stdout);
+
+        // Simulate a tick (virtual time when replaying)
+        if (scenario_path == NULL) usleep(TICKS_MS * 1000/2);
+        emulate_wait();
         current_time_ms += TICKS_MS;
+
+        // Save the state between two ticks, once
+        if (save_path != NULL && current_time_ms >= save_at_ms) {
+            if (checkpoint_save(save_path, &state) != 0) {
+                fprintf(stderr, "Failed to save checkpoint %s\n", save_path);
+            } else {
+                printf("Saved checkpoint %s at %u ms\n", save_path, current_time_ms);
+            }
+            save_path = NULL;
+        }
     }
 
-    // Unreachable, because of the infinite loop
+    netio_stop();
+    if (stats_fd >= 0) {
+        metrics_stop();
+        close(stats_fd);
+        unlink(STATS_SOCKET_PATH);
+    }
+    stats_print(stdout, scheduler_name, current_time_ms);
+    io_print_stats(stdout, current_time_ms);
+    power_print_stats(stdout, current_time_ms);
+    group_print_stats(stdout);
+    hotplug_print_stats(stdout, current_time_ms);
+    emulate_print_stats(stdout);
+    emulate_stop();
+    task_table_free(&blocked_tasks);
+    PHASE_DUMP(stdout);
+    if (scenario_path != NULL) {
+        FILE *report = report_path ? fopen(report_path, "w") : stdout;
+        if (report == NULL) {
+            perror("fopen");
+            return EXIT_FAILURE;
+        }
+        replay_report(report, scheduler_name);
+        hotplug_print_stats(report, current_time_ms);
+        if (report != stdout) fclose(report);
+        return replay_done() ? 0 : EXIT_FAILURE;
+    }
+    if (server_fd >= 0) {
+        close(server_fd);
+        unlink(SOCKET_PATH);
+    }
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,110 @@
+#include "params.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "rr.h"
+
+sim_params_t sim_params = {
+    .migration_penalty_ms = 10,
+    .remote_migration_penalty_ms = 30,
+    .affinity_wait_ms = 10,
+    .context_switch_ms = 1,
+    .smt_slowdown_pct = 30,
+    .rr_quantum_ms = QUANTUM_MS,
+    .rr_latency_ms = RR_LATENCY_MS,
+    .rr_min_granularity_ms = RR_MIN_GRANULARITY_MS,
+    .mlfq_quantum0_ms = 500,
+    .mlfq_quantum1_ms = 1000,
+    .mlfq_quantum2_ms = 2000,
+    .mlfq_aging_period_ms = 1000,
+    .mlfq_aging_threshold_ms = 2000,
+    .mlfq_wakeup_preempt = 0,
+    .mlfq_io_boost_ms = 0,
+    .sjf_alpha_pct = 50,
+    .sjf_initial_guess_ms = 1000,
+    .cstate_deep_after_ms = 50,
+    .cstate_deep_wake_ms = 1,
+    .governor_period_ms = 50,
+    .ondemand_up_pct = 80,
+    .power_consolidate = 0,
+    .big_burst_ms = 1000,
+    .fair_quantum_ms = 100,
+    .slowdown_bound_ms = 1000,
+    .replay_max_ms = 3600000,
+};
+
+typedef struct {
+    const char *name;
+    size_t offset;
+} param_desc_t;
+
+#define PARAM(field) { #field, offsetof(sim_params_t, field) }
+
+static const param_desc_t PARAMS[] = {
+    PARAM(migration_penalty_ms),
+    PARAM(remote_migration_penalty_ms),
+    PARAM(affinity_wait_ms),
+    PARAM(context_switch_ms),
+    PARAM(smt_slowdown_pct),
+    PARAM(rr_quantum_ms),
+    PARAM(rr_latency_ms),
+    PARAM(rr_min_granularity_ms),
+    PARAM(mlfq_quantum0_ms),
+    PARAM(mlfq_quantum1_ms),
+    PARAM(mlfq_quantum2_ms),
+    PARAM(mlfq_aging_period_ms),
+    PARAM(mlfq_aging_threshold_ms),
+    PARAM(mlfq_wakeup_preempt),
+    PARAM(mlfq_io_boost_ms),
+    PARAM(sjf_alpha_pct),
+    PARAM(sjf_initial_guess_ms),
+    PARAM(cstate_deep_after_ms),
+    PARAM(cstate_deep_wake_ms),
+    PARAM(governor_period_ms),
+    PARAM(ondemand_up_pct),
+    PARAM(power_consolidate),
+    PARAM(big_burst_ms),
+    PARAM(fair_quantum_ms),
+    PARAM(slowdown_bound_ms),
+    PARAM(emulate),
+    PARAM(emulate_pages),
+    PARAM(replay_max_ms),
+    { NULL, 0 }
+};
+
+int params_set(const char *assignment) {
+    const char *eq = strchr(assignment, '=');
+    if (eq == NULL) {
+        fprintf(stderr, "Invalid parameter %s, expected name=value\n", assignment);
+        return -1;
+    }
+    size_t name_len = (size_t)(eq - assignment);
+
+    for (int i = 0; PARAMS[i].name != NULL; i++) {
+        if (strlen(PARAMS[i].name) != name_len || strncmp(PARAMS[i].name, assignment, name_len) != 0) {
+            continue;
+        }
+        char *endptr;
+        errno = 0;
+        long val = strtol(eq + 1, &endptr, 10);
+        if (errno != 0 || *endptr != '\0' || endptr == eq + 1 || val < 0 || val > INT_MAX) {
+            fprintf(stderr, "Invalid value for parameter %s: %s\n", PARAMS[i].name, eq + 1);
+            return -1;
+        }
+        *(uint32_t *)((char *)&sim_params + PARAMS[i].offset) = (uint32_t)val;
+        return 0;
+    }
+    fprintf(stderr, "Unknown parameter %.*s\n", (int)name_len, assignment);
+    return -1;
+}
+
+void params_print(FILE *out) {
+    for (int i = 0; PARAMS[i].name != NULL; i++) {
+        fprintf(out, " - %s=%u\n", PARAMS[i].name,
+                *(const uint32_t *)((const char *)&sim_params + PARAMS[i].offset));
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef PARAMS_H
+#define PARAMS_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+// Simulation parameters that can be changed at run time with "-p name=value".
+// The defaults are defined in params.c.
+typedef struct {
+    uint32_t migration_penalty_ms;  // Extra burst time charged when a task resumes on another CPU of the same node
+    uint32_t remote_migration_penalty_ms; // Extra burst time charged when a task resumes on another node
+    uint32_t affinity_wait_ms;      // A task waits for its previous CPU if it is free within this time
+    uint32_t context_switch_ms;     // CPU time spent switching to a task dispatched on a CPU that ran another task
+    uint32_t smt_slowdown_pct;      // Progress lost by a task for each busy SMT sibling of its CPU
+    uint32_t rr_quantum_ms;         // Quantum of the RR scheduler
+    uint32_t rr_latency_ms;         // Period in which RR-ADAPT runs every task of a CPU once
+    uint32_t rr_min_granularity_ms; // Shortest time slice of RR-ADAPT
+    uint32_t mlfq_quantum0_ms;      // Quantum of the highest MLFQ level
+    uint32_t mlfq_quantum1_ms;      // Quantum of the middle MLFQ level
+    uint32_t mlfq_quantum2_ms;      // Quantum of the lowest MLFQ level
+    uint32_t mlfq_aging_period_ms;  // Interval between MLFQ aging passes
+    uint32_t mlfq_aging_threshold_ms; // Waiting time after which MLFQ promotes a task
+    uint32_t mlfq_wakeup_preempt;   // 1 to let a ready MLFQ task preempt a running task of a lower level
+    uint32_t mlfq_io_boost_ms;      // CPU time an MLFQ task runs above level 0 after an I/O request (0 = off)
+    uint32_t sjf_alpha_pct;         // Weight (0-100) of the last burst in the SJF-EXP prediction
+    uint32_t sjf_initial_guess_ms;  // SJF-EXP prediction for the first burst of a task
+    uint32_t cstate_deep_after_ms;  // Idle time after which a CPU enters the deep idle state
+    uint32_t cstate_deep_wake_ms;   // Time to wake up a CPU from the deep idle state
+    uint32_t governor_period_ms;    // Interval between frequency decisions of the governor
+    uint32_t ondemand_up_pct;       // Utilization that makes ondemand jump to the highest frequency
+    uint32_t fair_quantum_ms;       // Time slice of a task in the FAIR scheduler
+    uint32_t big_burst_ms;          // Bursts at least this long prefer the big cores, shorter ones the little cores
+    uint32_t power_consolidate;     // 1 to prefer awake CPUs, letting the others sleep (consolidation)
+    uint32_t slowdown_bound_ms;     // Shortest burst time used in the bounded slowdown
+    uint32_t emulate;               // 1 to also run the CPU time of the tasks as real work on the host (see emulate.h)
+    uint32_t emulate_pages;         // Working set of each task in the emulation, in 4 KB pages (0 for a busy loop)
+    uint32_t replay_max_ms;         // A replay that has not finished at this virtual time fails (0 = no limit)
+} sim_params_t;
+
+extern sim_params_t sim_params;
+
+/**
+ * @brief Set a simulation parameter from a "name=value" string
+ *
+ * @param assignment The string with the parameter name and the new value
+ * @return 0 on success, -1 if the parameter is unknown or the value is invalid
+ */
+int params_set(const char *assignment);
+
+/**
+ * @brief Print all parameters and their current values
+ *
+ * @param out The stream where the parameters will be printed
+ */
+void params_print(FILE *out);
+
+#endif // PARAMS_H
@@ -0,0 +1,73 @@
+#include "phase.h"
+
+#ifdef PHASE_TIMING
+
+#include <inttypes.h>
+#include <signal.h>
+#include <time.h>
+
+#include "hist.h"
+
+static const char *PHASE_NAMES[PHASE_COUNT] = {
+    "check_new_commands",
+    "check_blocked_queue",
+    "check_new_commands (2nd)",
+    "scheduler",
+};
+
+static hist_t phase_hist[PHASE_COUNT];
+static volatile sig_atomic_t dump_requested = 0;
+
+static void handle_dump_signal(int signum) {
+    (void)signum;
+    dump_requested = 1;
+}
+
+uint64_t phase_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+void phase_record(phase_en phase, uint64_t duration) {
+    hist_record(&phase_hist[phase], duration);
+}
+
+void phase_init(void) {
+    struct sigaction sa = {0};
+    sa.sa_handler = handle_dump_signal;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = SA_RESTART;
+    sigaction(SIGUSR1, &sa, NULL);
+}
+
+void phase_poll(FILE *out) {
+    if (dump_requested) {
+        dump_requested = 0;
+        phase_dump(out);
+    }
+}
+
+void phase_dump(FILE *out) {
+    fprintf(out, "Phase timing (ns):\n");
+    for (int p = 0; p < PHASE_COUNT; p++) {
+        const hist_t *h = &phase_hist[p];
+        fprintf(out, "  %-26s count %" PRIu64, PHASE_NAMES[p], h->count);
+        if (h->count == 0) {
+            fprintf(out, "\n");
+            continue;
+        }
+        fprintf(out, ", avg %" PRIu64 ", min %" PRIu64 ", p50 <%" PRIu64 ", p99 <%" PRIu64
+                ", max %" PRIu64 "\n",
+                h->total_ns / h->count, h->min_ns, hist_percentile(h, 0.5),
+                hist_percentile(h, 0.99), h->max_ns);
+        for (int b = 0; b < HIST_BUCKETS; b++) {
+            if (h->buckets[b] == 0) continue;
+            fprintf(out, "    [%12" PRIu64 ", %12" PRIu64 "): %" PRIu64 "\n",
+                    b ? (uint64_t)1 << b : 0, (uint64_t)2 << b, h->buckets[b]);
+        }
+    }
+    fflush(out);
+}
+
+#endif // PHASE_TIMING
@@ -0,0 +1,71 @@
+#ifndef PHASE_H
+#define PHASE_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+ * Timing of the phases of the main loop.
+ * Each phase is timed with CLOCK_MONOTONIC_RAW and recorded in a histogram with
+ * power of two buckets (see hist.h). The histograms are printed on SIGUSR1
+ * and at exit. Like DBG, the instrumentation is only compiled in when requested:
+ * it is active if PHASE_TIMING is defined (cmake -DPHASE_TIMING=ON), otherwise the
+ * macros expand to nothing.
+ */
+
+typedef enum {
+    PHASE_COMMANDS = 0,     // check_new_commands() at the start of the tick
+    PHASE_BLOCKED,          // check_blocked_queue()
+    PHASE_COMMANDS_AGAIN,   // check_new_commands() after the blocked queue
+    PHASE_SCHEDULER,        // The scheduler
+    PHASE_COUNT
+} phase_en;
+
+#ifdef PHASE_TIMING
+
+/**
+ * @brief Current time of the raw monotonic clock in nanoseconds
+ */
+uint64_t phase_now_ns(void);
+
+/**
+ * @brief Record the duration of one execution of a phase
+ *
+ * @param phase    The phase
+ * @param duration The duration in nanoseconds
+ */
+void phase_record(phase_en phase, uint64_t duration);
+
+/**
+ * @brief Install the SIGUSR1 handler that requests a dump of the histograms
+ */
+void phase_init(void);
+
+/**
+ * @brief Print the histograms if a dump was requested with SIGUSR1
+ *
+ * @param out The stream where the histograms will be printed
+ */
+void phase_poll(FILE *out);
+
+/**
+ * @brief Print the histograms of all phases
+ *
+ * @param out The stream where the histograms will be printed
+ */
+void phase_dump(FILE *out);
+
+  #define PHASE_BEGIN(phase) uint64_t phase_start_##phase = phase_now_ns()
+  #define PHASE_END(phase) phase_record(phase, phase_now_ns() - phase_start_##phase)
+  #define PHASE_INIT() phase_init()
+  #define PHASE_POLL(out) phase_poll(out)
+  #define PHASE_DUMP(out) phase_dump(out)
+#else
+  #define PHASE_BEGIN(phase) ((void)0)
+  #define PHASE_END(phase) ((void)0)
+  #define PHASE_INIT() ((void)0)
+  #define PHASE_POLL(out) ((void)0)
+  #define PHASE_DUMP(out) ((void)0)
+#endif
+
+#endif // PHASE_H
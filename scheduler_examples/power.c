@@ -0,0 +1,175 @@
+#include "power.h"
+
+#include <inttypes.h>
+#include <string.h>
+
+#include "msg.h"
+#include "params.h"
+#include "stats.h"
+#include "topology.h"
+
+// Idle states
+typedef enum {
+    CSTATE_ACTIVE = 0,      // Running a task
+    CSTATE_HALT,            // C1: idle, wakes up immediately
+    CSTATE_DEEP,            // C6: idle with the core powered down, slow to wake up
+} power_cstate_en;
+
+// Frequency levels, from the highest to the lowest, and the power of a busy CPU at each one.
+// The power falls faster than the frequency (lower voltage), so slow CPUs use less energy per work.
+static const uint32_t PSTATE_SPEED_PCT[POWER_NUM_PSTATES] = {100, 70, 40};
+static const uint32_t PSTATE_ACTIVE_MW[POWER_NUM_PSTATES] = {4000, 1800, 700};
+static const uint32_t CSTATE_IDLE_MW[] = {0, 500, 50};
+
+static const char *GOVERNOR_NAMES[] = {
+    "performance",
+    "powersave",
+    "ondemand",
+    "schedutil",
+    NULL
+};
+
+typedef struct {
+    int pstate;                     // Current frequency level (index in PSTATE_SPEED_PCT)
+    power_cstate_en cstate;
+    uint32_t idle_ms;               // Time idle since the last task
+    uint32_t window_busy_ms;        // Busy time in the current governor window
+    uint32_t window_ms;             // Length of the current governor window
+    uint64_t energy_uj;
+    uint64_t pstate_ms[POWER_NUM_PSTATES];  // Busy time at each frequency
+    uint64_t deep_idle_ms;          // Time in the deep idle state
+    uint64_t wakeups;               // Wake-ups from the deep idle state
+} power_cpu_t;
+
+static power_governor_en governor = GOV_PERFORMANCE;
+static power_cpu_t power_cpus[MAX_CPUS];
+
+int power_set_governor(const char *name) {
+    for (int i = 0; GOVERNOR_NAMES[i] != NULL; i++) {
+        if (strcmp(name, GOVERNOR_NAMES[i]) == 0) {
+            governor = (power_governor_en)i;
+            // The initial frequency, before the first governor window
+            int pstate = (governor == GOV_POWERSAVE) ? POWER_NUM_PSTATES - 1 : 0;
+            for (int c = 0; c < MAX_CPUS; c++) power_cpus[c].pstate = pstate;
+            return 0;
+        }
+    }
+    fprintf(stderr, "Unknown governor %s, options are performance, powersave, ondemand, schedutil\n", name);
+    return -1;
+}
+
+uint32_t power_speed_pct(int cpu) {
+    return PSTATE_SPEED_PCT[power_cpus[cpu].pstate];
+}
+
+int power_is_deep_idle(int cpu) {
+    return power_cpus[cpu].cstate == CSTATE_DEEP;
+}
+
+uint32_t power_wake(int cpu) {
+    power_cpu_t *pc = &power_cpus[cpu];
+    uint32_t latency = 0;
+    if (pc->cstate == CSTATE_DEEP) {
+        latency = sim_params.cstate_deep_wake_ms;
+        pc->wakeups++;
+    }
+    pc->cstate = CSTATE_ACTIVE;
+    pc->idle_ms = 0;
+    return latency;
+}
+
+void power_offline(int cpu) {
+    power_cpu_t *pc = &power_cpus[cpu];
+    pc->cstate = CSTATE_DEEP;
+    // Idle long enough to stay in deep idle while it is online without a task
+    pc->idle_ms = sim_params.cstate_deep_after_ms;
+    pc->window_busy_ms = 0;
+    pc->window_ms = 0;
+}
+
+// Lowest frequency level with at least the given speed
+static int pstate_for_speed(uint32_t speed_pct) {
+    for (int p = POWER_NUM_PSTATES - 1; p > 0; p--) {
+        if (PSTATE_SPEED_PCT[p] >= speed_pct) return p;
+    }
+    return 0;
+}
+
+// Choose the frequency for the next window from the utilization of the last one
+static void run_governor(power_cpu_t *pc) {
+    uint32_t util_pct = pc->window_ms ? pc->window_busy_ms * 100 / pc->window_ms : 0;
+    switch (governor) {
+        case GOV_POWERSAVE:
+            pc->pstate = POWER_NUM_PSTATES - 1;
+            break;
+        case GOV_ONDEMAND:
+            if (util_pct >= sim_params.ondemand_up_pct) {
+                pc->pstate = 0;
+            } else if (pc->pstate < POWER_NUM_PSTATES - 1) {
+                pc->pstate++;
+            }
+            break;
+        case GOV_SCHEDUTIL:
+            // The busy time was measured at the current frequency, scale it to the highest one
+            pc->pstate = pstate_for_speed(util_pct * PSTATE_SPEED_PCT[pc->pstate] / 100 * 125 / 100);
+            break;
+        case GOV_PERFORMANCE:
+        default:
+            pc->pstate = 0;
+            break;
+    }
+    pc->window_busy_ms = 0;
+    pc->window_ms = 0;
+}
+
+void power_account_tick(pcb_t **cpus, int num_cpus) {
+    for (int i = 0; i < num_cpus; i++) {
+        power_cpu_t *pc = &power_cpus[i];
+        uint64_t energy_uj;     // mW * ms = uJ
+        if (cpus[i] != NULL) {
+            pc->cstate = CSTATE_ACTIVE;
+            pc->idle_ms = 0;
+            pc->window_busy_ms += TICKS_MS;
+            pc->pstate_ms[pc->pstate] += TICKS_MS;
+            energy_uj = (uint64_t)PSTATE_ACTIVE_MW[pc->pstate] * TICKS_MS;
+        } else {
+            pc->idle_ms += TICKS_MS;
+            pc->cstate = (pc->idle_ms > sim_params.cstate_deep_after_ms) ? CSTATE_DEEP : CSTATE_HALT;
+            if (pc->cstate == CSTATE_DEEP) pc->deep_idle_ms += TICKS_MS;
+            energy_uj = (uint64_t)CSTATE_IDLE_MW[pc->cstate] * TICKS_MS;
+        }
+        pc->energy_uj += energy_uj;
+        STAT_ADD(energy_uj, energy_uj);
+
+        pc->window_ms += TICKS_MS;
+        if (pc->window_ms >= sim_params.governor_period_ms) {
+            run_governor(pc);
+        }
+    }
+}
+
+uint64_t power_energy_uj(void) {
+    return STAT_GET(energy_uj);
+}
+
+void power_print_stats(FILE *out, uint32_t current_time_ms) {
+    uint64_t total_uj = power_energy_uj();
+    fprintf(out, "  Energy:            %.3f J (average %.2f W, governor %s)\n",
+            (double)total_uj / 1e6,
+            current_time_ms ? (double)total_uj / 1e3 / current_time_ms : 0.0,
+            GOVERNOR_NAMES[governor]);
+    int num_cpus = topo_num_cpus();
+    for (int i = 0; i < num_cpus; i++) {
+        const power_cpu_t *pc = &power_cpus[i];
+        fprintf(out, "  CPU %d: %.3f J, busy at", i, (double)pc->energy_uj / 1e6);
+        for (int p = 0; p < POWER_NUM_PSTATES; p++) {
+            fprintf(out, " %u%%: %" PRIu64 " ms%s", PSTATE_SPEED_PCT[p], pc->pstate_ms[p],
+                    p < POWER_NUM_PSTATES - 1 ? "," : "");
+        }
+        fprintf(out, "; deep idle %" PRIu64 " ms, %" PRIu64 " wake-ups\n", pc->deep_idle_ms, pc->wakeups);
+    }
+}
+
+void power_checkpoint(checkpoint_t *ck) {
+    ckpt_bytes(ck, power_cpus, sizeof(power_cpus));
+}
@@ -0,0 +1,94 @@
+#ifndef POWER_H
+#define POWER_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include "checkpoint.h"
+#include "queue.h"
+
+/*
+ * Energy model of the CPUs.
+ * Each CPU runs at one of POWER_NUM_PSTATES frequency levels (P-states), chosen
+ * by a governor, and a task advances in proportion to the frequency. An idle CPU
+ * first halts (C1), and after sim_params.cstate_deep_after_ms enters a deep idle
+ * state (C6) that costs sim_params.cstate_deep_wake_ms to wake up from. The
+ * energy of each CPU is estimated from the power of its state in every tick.
+ */
+
+#define POWER_NUM_PSTATES 3
+
+// Frequency governors
+typedef enum {
+    GOV_PERFORMANCE = 0,    // Always the highest frequency
+    GOV_POWERSAVE,          // Always the lowest frequency
+    GOV_ONDEMAND,           // Highest frequency when busy, then step down while the load is low
+    GOV_SCHEDUTIL,          // Frequency proportional to the recent utilization, with 25% headroom
+} power_governor_en;
+
+/**
+ * @brief Select the frequency governor by name (performance, powersave, ondemand, schedutil)
+ *
+ * @param name The name of the governor
+ * @return 0 on success, -1 if the governor is unknown
+ */
+int power_set_governor(const char *name);
+
+/**
+ * @brief Speed of a CPU at its current frequency, in percent of the highest frequency
+ */
+uint32_t power_speed_pct(int cpu);
+
+/**
+ * @brief Check if a CPU is in the deep idle state
+ */
+int power_is_deep_idle(int cpu);
+
+/**
+ * @brief Wake up a CPU where a task is being dispatched
+ *
+ * @param cpu The index of the CPU
+ * @return The wake-up latency in milliseconds (0 if the CPU was not in deep idle)
+ */
+uint32_t power_wake(int cpu);
+
+/**
+ * @brief Power down a CPU going offline
+ *
+ * The CPU is not accounted while it is offline. It comes back online in the deep
+ * idle state, so the first task dispatched on it pays the wake-up latency.
+ *
+ * @param cpu The index of the CPU
+ */
+void power_offline(int cpu);
+
+/**
+ * @brief Account one tick of energy, update the idle states and run the governor
+ *
+ * @param cpus     Array with the task running on each CPU (NULL if idle)
+ * @param num_cpus Number of CPUs
+ */
+void power_account_tick(pcb_t **cpus, int num_cpus);
+
+/**
+ * @brief Energy consumed by all CPUs since the start, in microjoules
+ */
+uint64_t power_energy_uj(void);
+
+/**
+ * @brief Print the energy, frequency and idle state residency of each CPU
+ *
+ * @param out             The stream where the statistics will be printed
+ * @param current_time_ms Current simulation time in milliseconds
+ */
+void power_print_stats(FILE *out, uint32_t current_time_ms);
+
+/**
+ * @brief Save or restore the frequency, idle state and energy of the CPUs
+ *
+ * The governor is not saved, so a checkpoint can be restored with another one.
+ *
+ * @param ck The checkpoint
+ */
+void power_checkpoint(checkpoint_t *ck);
+
+#endif // POWER_H
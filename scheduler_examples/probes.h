@@ -0,0 +1,46 @@
+#ifndef PROBES_H
+#define PROBES_H
+
+/*
+ * User-level statically defined tracepoints (USDT) at the decisions of the simulator.
+ * When <sys/sdt.h> (systemtap-sdt-dev) is available, each probe is a single nop
+ * plus a note in the ELF file, and can be traced without rebuilding, e.g.:
+ *
+ *   bpftrace -e 'usdt:./scheduler:ossim:dispatch { printf("%d -> CPU %d\n", arg0, arg1); }'
+ *
+ * Otherwise, or if OSSIM_NO_PROBES is defined, the probes expand to nothing.
+ *
+ * Probes (provider "ossim") and their arguments:
+ *   accept(sockfd)                          A client connected
+ *   request_run(pid, time_ms, now_ms)       RUN request received
+ *   request_block(pid, time_ms, now_ms)     BLOCK request received
+ *   dispatch(pid, cpu, last_cpu, now_ms)    Task placed on a CPU
+ *   preempt_quantum(pid, cpu, level, now_ms) Quantum expired (RR: level 0)
+ *   preempt_sjf(pid, by_pid, cpu, now_ms)   Task preempted by a shorter one
+ *   preempt_wakeup(pid, by_pid, cpu, now_ms) MLFQ task preempted by a ready task of a higher level
+ *   mlfq_demote(pid, from_level, to_level)  MLFQ level lowered after a quantum
+ *   mlfq_promote(pid, from_level, to_level) MLFQ level raised by aging
+ *   block_expired(pid, now_ms)              I/O request finished
+ *   done_sent(pid, io, now_ms)              DONE sent (io is 1 after a BLOCK, 0 after a RUN)
+ */
+
+#if !defined(OSSIM_NO_PROBES) && defined(__has_include)
+  #if __has_include(<sys/sdt.h>)
+    #include <sys/sdt.h>
+    #define OSSIM_HAVE_PROBES 1
+  #endif
+#endif
+
+#ifdef OSSIM_HAVE_PROBES
+  #define PROBE1(name, a)          DTRACE_PROBE1(ossim, name, a)
+  #define PROBE2(name, a, b)       DTRACE_PROBE2(ossim, name, a, b)
+  #define PROBE3(name, a, b, c)    DTRACE_PROBE3(ossim, name, a, b, c)
+  #define PROBE4(name, a, b, c, d) DTRACE_PROBE4(ossim, name, a, b, c, d)
+#else
+  #define PROBE1(name, a)          ((void)0)
+  #define PROBE2(name, a, b)       ((void)0)
+  #define PROBE3(name, a, b, c)    ((void)0)
+  #define PROBE4(name, a, b, c, d) ((void)0)
+#endif
+
+#endif // PROBES_H
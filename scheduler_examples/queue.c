@@ -13,6 +13,19 @@ pcb_t *new_pcb(pid_t pid, uint32_t sockfd, uint32_t time_ms) {
     new_task->sockfd = sockfd;
     new_task->time_ms = time_ms;
     new_task->ellapsed_time_ms = 0;
+    new_task->last_update_time_ms = 0;
+    new_task->last_cpu = -1;
+    new_task->io_device = 0;
+    new_task->io_position = 0;
+    new_task->io_wait_start_ms = 0;
+    new_task->parallelism = 1;
+    new_task->burst_ms = 0;
+    new_task->burst_run_ms = 0;
+    new_task->predicted_ms = 0;
+    new_task->group = -1;
+    new_task->request_ms = 0;
+    new_task->slice_ms = 0;
+    new_task->clock_offset_ms = 0;
     return new_task;
 }
 
@@ -29,6 +42,7 @@ int enqueue_pcb(queue_t* q, pcb_t* task) {
         q->head = elem;
     }
     q->tail = elem;
+    q->size++;
     return 1;
 }
 
@@ -41,6 +55,7 @@ pcb_t* dequeue_pcb(queue_t* q) {
     q->head = node->next;
     if (!q->head)
         q->tail = NULL;
+    q->size--;
 
     free(node);
     return task;
@@ -60,6 +75,7 @@ queue_elem_t *remove_queue_elem(queue_t* q, queue_elem_t* elem) {
             if (it == q->tail) {
                 q->tail = prev;
             }
+            q->size--;
             return it;
         }
         prev = it;
@@ -19,6 +19,18 @@ typedef struct pcb_st{
     uint32_t slice_start_ms;       // Time when the current time slice started
     uint32_t sockfd;               // Socket file descriptor for communication with the application
     uint32_t last_update_time_ms;  // Last time the PCB was updataed
+    int32_t last_cpu;              // CPU where the task ran last (-1 if it never ran)
+    int32_t io_device;             // I/O device used by the current BLOCK request
+    uint32_t io_position;          // Position of the current BLOCK request on its device
+    uint32_t io_wait_start_ms;     // Time when the task started waiting for the I/O device
+    uint32_t parallelism;          // CPUs the current RUN request needs at the same time (gang)
+    uint32_t burst_ms;             // CPU time requested by the current RUN request
+    uint32_t burst_run_ms;         // CPU time received in the current burst (across preemptions)
+    uint32_t predicted_ms;         // Predicted length of the current burst (0 before the first burst)
+    int32_t group;                 // Group (tenant) of the application, index in the group table (-1 before its first request)
+    uint32_t request_ms;           // Time the current RUN request was received
+    uint32_t slice_ms;             // Time slice given at the last dispatch (RR-ADAPT)
+    uint32_t clock_offset_ms;      // This clock minus the application's clock (task moved from another shard)
 } pcb_t;
 
 // Define singly linked list elements
@@ -33,7 +45,7 @@ typedef struct queue_elem_st {
 typedef struct queue_st  {
     queue_elem_t* head;
     queue_elem_t* tail;
-    int size;
+    int size;           // Number of elements in the queue
 } queue_t;
 
 /**
@@ -0,0 +1,418 @@
+#include "replay.h"
+
+#include <errno.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "burst_queue.h"
+#include "debug.h"
+#include "msg.h"
+#include "netio.h"
+#include "power.h"
+#include "stats.h"
+
+#define REPLAY_MAX_LINE 1024
+#define REPLAY_NAME_LEN 64
+// Virtual connections and PIDs are numbered from these values, in the order of the script
+#define REPLAY_FD_BASE 1000
+#define REPLAY_PID_BASE 100
+
+typedef struct {
+    process_request_t request;  // RUN or BLOCK
+    uint32_t time_ms;
+    uint32_t parallelism;       // CPUs needed at the same time (RUN only)
+    char device[MSG_DEVICE_LEN];    // I/O device (BLOCK only, empty to spread by PID)
+    uint32_t position;          // Position on the device (BLOCK only)
+} replay_request_t;
+
+// A virtual application
+typedef struct {
+    char name[REPLAY_NAME_LEN];
+    char group[MSG_GROUP_LEN];      // OSSIM_GROUP given on the line, or the name
+    uint32_t arrival_ms;            // Time when the application connects
+    replay_request_t *requests;
+    int num_requests;
+    int next;                       // Index of the request waiting for DONE
+    int connected;
+    int finished;                   // Sent all its requests and disconnected
+    int started;                    // Received the first ACK
+    uint32_t start_ms;              // Time of the first ACK
+    uint32_t request_ms;            // Time of the ACK of the current request
+    uint32_t finish_ms;             // Time of the last DONE
+    uint32_t cpu_ms;                // Sum of the RUN requests
+    uint32_t blocked_ms;            // Sum of the BLOCK requests
+} replay_client_t;
+
+static const char *scenario_name = NULL;
+static replay_client_t *clients = NULL;
+static int num_clients = 0;
+static int num_finished = 0;
+
+// Response time (ACK to DONE) of each RUN request, for the percentiles
+static uint32_t *responses_ms = NULL;
+static size_t num_responses = 0;
+static size_t max_responses = 0;
+
+static replay_client_t *add_client(const char *name, const char *group, uint32_t arrival_ms) {
+    replay_client_t *tmp = realloc(clients, (size_t)(num_clients + 1) * sizeof(replay_client_t));
+    if (!tmp) {
+        perror("realloc");
+        return NULL;
+    }
+    clients = tmp;
+    replay_client_t *c = &clients[num_clients++];
+    memset(c, 0, sizeof(*c));
+    snprintf(c->name, sizeof(c->name), "%s", name);
+    snprintf(c->group, sizeof(c->group), "%s", group ? group : name);
+    c->arrival_ms = arrival_ms;
+    return c;
+}
+
+static int add_request(replay_client_t *c, process_request_t request, uint32_t time_ms, uint32_t parallelism,
+                       const burst_t *burst) {
+    replay_request_t *tmp = realloc(c->requests, (size_t)(c->num_requests + 1) * sizeof(replay_request_t));
+    if (!tmp) {
+        perror("realloc");
+        return -1;
+    }
+    c->requests = tmp;
+    c->requests[c->num_requests++] = (replay_request_t){
+        .request = request, .time_ms = time_ms, .parallelism = parallelism
+    };
+    if (burst != NULL) {
+        replay_request_t *r = &c->requests[c->num_requests - 1];
+        memcpy(r->device, burst->device, sizeof(r->device));
+        r->position = burst->position;
+    }
+    if (request == PROCESS_REQUEST_RUN) c->cpu_ms += time_ms;
+    else c->blocked_ms += time_ms;
+    return 0;
+}
+
+// Find a burst file: as given, relative to the directory of the script, or by name in that directory
+static int resolve_path(const char *scenario_dir, const char *path, char *out, size_t size) {
+    snprintf(out, size, "%s", path);
+    if (access(out, R_OK) == 0) return 0;
+    if (path[0] != '/') {
+        snprintf(out, size, "%s/%s", scenario_dir, path);
+        if (access(out, R_OK) == 0) return 0;
+    }
+    const char *slash = strrchr(path, '/');
+    snprintf(out, size, "%s/%s", scenario_dir, slash ? slash + 1 : path);
+    if (access(out, R_OK) == 0) return 0;
+    fprintf(stderr, "Burst file %s not found\n", path);
+    return -1;
+}
+
+// Same name as app-io: the basename of the file without extension
+static void basename_no_ext(const char *path, char *out, size_t size) {
+    const char *slash = strrchr(path, '/');
+    const char *base = slash ? slash + 1 : path;
+    const char *dot = strrchr(base, '.');
+    size_t len = dot ? (size_t)(dot - base) : strlen(base);
+    if (len >= size) len = size - 1;
+    memcpy(out, base, len);
+    out[len] = '\0';
+}
+
+static int load_app(char **args, int nargs, const char *group, uint32_t arrival_ms) {
+    if (nargs != 3 && nargs != 4) {
+        fprintf(stderr, "Expected ./app <name> <time_s> [cpus]\n");
+        return -1;
+    }
+    char *endptr;
+    errno = 0;
+    long time_s = strtol(args[2], &endptr, 10);
+    if (errno != 0 || *endptr != '\0' || time_s < 0 || time_s > INT_MAX / 1000) {
+        fprintf(stderr, "Invalid time: %s\n", args[2]);
+        return -1;
+    }
+    long parallelism = 1;
+    if (nargs == 4) {
+        parallelism = strtol(args[3], &endptr, 10);
+        if (*endptr != '\0' || parallelism < 1 || parallelism > INT_MAX) {
+            fprintf(stderr, "Invalid number of CPUs: %s\n", args[3]);
+            return -1;
+        }
+    }
+    replay_client_t *c = add_client(args[1], group, arrival_ms);
+    if (c == NULL) return -1;
+    return add_request(c, PROCESS_REQUEST_RUN, (uint32_t)time_s * 1000, (uint32_t)parallelism, NULL);
+}
+
+static int load_app_io(char **args, int nargs, const char *group, uint32_t arrival_ms, const char *scenario_dir) {
+    if (nargs != 2) {
+        fprintf(stderr, "Expected ./app-io <bursts.csv>\n");
+        return -1;
+    }
+    char path[PATH_MAX];
+    if (resolve_path(scenario_dir, args[1], path, sizeof(path)) != 0) return -1;
+
+    burst_queue_t bursts = {.head = NULL, .tail = NULL};
+    if (read_queue_from_file(&bursts, path) <= 0) {
+        fprintf(stderr, "Failed to read burst file %s\n", path);
+        return -1;
+    }
+    char name[REPLAY_NAME_LEN];
+    basename_no_ext(path, name, sizeof(name));
+    replay_client_t *c = add_client(name, group, arrival_ms);
+
+    int ret = c ? 0 : -1;
+    burst_t *burst;
+    while ((burst = dequeue_burst(&bursts)) != NULL) {
+        if (ret == 0) ret = add_request(c, PROCESS_REQUEST_RUN, burst->burst_time_ms, 1, NULL);
+        if (ret == 0 && burst->block_time_ms > 0) {
+            ret = add_request(c, PROCESS_REQUEST_BLOCK, burst->block_time_ms, 0, burst);
+        }
+        free(burst);
+    }
+    return ret;
+}
+
+int replay_load(const char *scenario_path) {
+    FILE *file = fopen(scenario_path, "r");
+    if (!file) {
+        perror("fopen");
+        return -1;
+    }
+    char scenario_dir[PATH_MAX];
+    const char *slash = strrchr(scenario_path, '/');
+    if (slash) {
+        snprintf(scenario_dir, sizeof(scenario_dir), "%.*s", (int)(slash - scenario_path), scenario_path);
+    } else {
+        snprintf(scenario_dir, sizeof(scenario_dir), ".");
+    }
+    scenario_name = slash ? slash + 1 : scenario_path;
+
+    char line[REPLAY_MAX_LINE];
+    uint32_t arrival_ms = 0;
+    int line_no = 0;
+    int ret = 0;
+    while (ret == 0 && fgets(line, sizeof(line), file)) {
+        line_no++;
+        char *comment = strchr(line, '#');
+        if (comment) *comment = '\0';
+
+        // Split in words, ignoring the "&" that runs the applications in background
+        char *args[8];
+        int nargs = 0;
+        for (char *tok = strtok(line, " \t\r\n;"); tok && nargs < 8; tok = strtok(NULL, " \t\r\n;")) {
+            size_t len = strlen(tok);
+            if (tok[len - 1] == '&') tok[--len] = '\0';
+            if (len > 0) args[nargs++] = tok;
+        }
+        if (nargs == 0 || strcmp(args[0], "wait") == 0) continue;
+
+        // "OSSIM_GROUP=name ./app ..." sets the group of the application, as in the shell
+        const char *group = NULL;
+        if (strncmp(args[0], "OSSIM_GROUP=", strlen("OSSIM_GROUP=")) == 0 && nargs > 1) {
+            group = args[0] + strlen("OSSIM_GROUP=");
+            memmove(args, args + 1, (size_t)--nargs * sizeof(char *));
+        }
+
+        const char *cmd = strrchr(args[0], '/');
+        cmd = cmd ? cmd + 1 : args[0];
+        if (strcmp(cmd, "app") == 0) {
+            ret = load_app(args, nargs, group, arrival_ms);
+        } else if (strcmp(cmd, "app-io") == 0) {
+            ret = load_app_io(args, nargs, group, arrival_ms, scenario_dir);
+        } else if (strcmp(cmd, "sleep") == 0 && nargs == 2) {
+            char *endptr;
+            double seconds = strtod(args[1], &endptr);
+            if (*endptr != '\0' || seconds < 0) {
+                fprintf(stderr, "Invalid sleep time: %s\n", args[1]);
+                ret = -1;
+            } else {
+                // Arrivals are rounded to the tick
+                arrival_ms += (uint32_t)(seconds * 1000 / TICKS_MS + 0.5) * TICKS_MS;
+            }
+        } else {
+            fprintf(stderr, "%s:%d: ignoring unknown command %s\n", scenario_path, line_no, args[0]);
+        }
+        if (ret != 0) fprintf(stderr, "%s:%d: invalid line\n", scenario_path, line_no);
+    }
+    fclose(file);
+    if (ret == 0 && num_clients == 0) {
+        fprintf(stderr, "No applications in scenario %s\n", scenario_path);
+        ret = -1;
+    }
+    return ret;
+}
+
+static replay_client_t *find_client(int sockfd) {
+    int i = sockfd - REPLAY_FD_BASE;
+    return (i >= 0 && i < num_clients) ? &clients[i] : NULL;
+}
+
+static void send_request(int i) {
+    replay_client_t *c = &clients[i];
+    msg_t msg = {
+        .pid = REPLAY_PID_BASE + i,
+        .request = c->requests[c->next].request,
+        .time_ms = c->requests[c->next].time_ms,
+        .parallelism = c->requests[c->next].parallelism
+    };
+    memcpy(msg.group, c->group, sizeof(msg.group));
+    memcpy(msg.device, c->requests[c->next].device, sizeof(msg.device));
+    msg.position = c->requests[c->next].position;
+    netio_inject(NET_EVENT_MESSAGE, REPLAY_FD_BASE + i, &msg);
+}
+
+static void add_response(uint32_t response_ms) {
+    if (num_responses == max_responses) {
+        size_t new_max = max_responses ? max_responses * 2 : 256;
+        uint32_t *tmp = realloc(responses_ms, new_max * sizeof(uint32_t));
+        if (!tmp) {
+            perror("realloc");
+            return;
+        }
+        responses_ms = tmp;
+        max_responses = new_max;
+    }
+    responses_ms[num_responses++] = response_ms;
+}
+
+static int compare_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Message sent by the scheduler to a virtual application
+static void replay_send(int sockfd, const msg_t *msg) {
+    replay_client_t *c = find_client(sockfd);
+    if (c == NULL || c->finished) return;
+
+    if (msg->request == PROCESS_REQUEST_ACK) {
+        if (!c->started) {
+            c->started = 1;
+            c->start_ms = msg->time_ms;
+        }
+        c->request_ms = msg->time_ms;
+    } else if (msg->request == PROCESS_REQUEST_DONE) {
+        c->finish_ms = msg->time_ms;
+        if (c->requests[c->next].request == PROCESS_REQUEST_RUN) {
+            add_response(msg->time_ms - c->request_ms);
+        }
+        if (++c->next < c->num_requests) {
+            send_request((int)(c - clients));
+        } else {
+            DBG("Replay: application %s finished at %u ms\n", c->name, msg->time_ms);
+            c->finished = 1;
+            netio_inject(NET_EVENT_DISCONNECT, sockfd, NULL);
+        }
+    }
+}
+
+static void replay_close(int sockfd) {
+    replay_client_t *c = find_client(sockfd);
+    if (c != NULL && c->finished) num_finished++;
+}
+
+static const netio_loopback_t replay_loopback = {
+    .send = replay_send,
+    .close = replay_close,
+};
+
+int replay_start(void) {
+    return netio_start_loopback(&replay_loopback);
+}
+
+void replay_tick(uint32_t current_time_ms) {
+    for (int i = 0; i < num_clients; i++) {
+        replay_client_t *c = &clients[i];
+        if (!c->connected && c->arrival_ms <= current_time_ms) {
+            c->connected = 1;
+            netio_inject(NET_EVENT_CONNECT, REPLAY_FD_BASE + i, NULL);
+            send_request(i);
+        }
+    }
+}
+
+int replay_done(void) {
+    return num_finished == num_clients;
+}
+
+void replay_report(FILE *out, const char *scheduler_name) {
+    fprintf(out, "Scenario %s, scheduler %s\n", scenario_name, scheduler_name);
+    fprintf(out, "%-12s %10s %10s %10s %10s %10s\n",
+            "App", "Finish", "Elapsed", "CPU", "BLOCKED", "Turnaround");
+    uint64_t total_turnaround_ms = 0;
+    int finished = 0;
+    uint32_t last_finish_ms = 0;
+    for (int i = 0; i < num_clients; i++) {
+        const replay_client_t *c = &clients[i];
+        if (!c->finished) {
+            fprintf(out, "%-12s unfinished\n", c->name);
+            continue;
+        }
+        uint32_t turnaround_ms = c->finish_ms - c->arrival_ms;
+        total_turnaround_ms += turnaround_ms;
+        finished++;
+        if (c->finish_ms > last_finish_ms) last_finish_ms = c->finish_ms;
+        fprintf(out, "%-12s %10u %10u %10u %10u %10u\n", c->name, c->finish_ms,
+                c->finish_ms - c->start_ms, c->cpu_ms, c->blocked_ms, turnaround_ms);
+    }
+    fprintf(out, "Mean turnaround: %.1f ms\n",
+            finished ? (double)total_turnaround_ms / finished : 0.0);
+
+    // Mean and nearest-rank percentile of the response time of the CPU bursts
+    uint64_t total_response_ms = 0;
+    for (size_t i = 0; i < num_responses; i++) total_response_ms += responses_ms[i];
+    uint32_t p99_ms = 0;
+    if (num_responses > 0) {
+        qsort(responses_ms, num_responses, sizeof(uint32_t), compare_u32);
+        size_t rank = (num_responses * 99 + 99) / 100;
+        p99_ms = responses_ms[rank - 1];
+    }
+    fprintf(out, "Response mean: %.1f ms\n",
+            num_responses ? (double)total_response_ms / (double)num_responses : 0.0);
+    fprintf(out, "Response p99: %u ms\n", p99_ms);
+    fprintf(out, "Throughput: %.3f bursts/s\n",
+            last_finish_ms ? (double)num_responses * 1000.0 / last_finish_ms : 0.0);
+    fprintf(out, "Energy: %.3f J\n", (double)power_energy_uj() / 1e6);
+    fprintf(out, "Context switches: %" PRIu64 "\n", STAT_GET(context_switches));
+}
+
+void replay_checkpoint(checkpoint_t *ck) {
+    uint32_t count = (uint32_t)num_clients;
+    ckpt_u32(ck, &count);
+    if (count != (uint32_t)num_clients) {
+        ckpt_fail(ck, "the checkpoint was saved with a different scenario");
+        return;
+    }
+    for (int i = 0; i < num_clients; i++) {
+        replay_client_t *c = &clients[i];
+        uint32_t num_requests = (uint32_t)c->num_requests;
+        ckpt_u32(ck, &num_requests);
+        if (num_requests != (uint32_t)c->num_requests) {
+            ckpt_fail(ck, "the checkpoint was saved with a different scenario");
+            return;
+        }
+        ckpt_bytes(ck, &c->next, sizeof(c->next));
+        ckpt_bytes(ck, &c->connected, sizeof(c->connected));
+        ckpt_bytes(ck, &c->finished, sizeof(c->finished));
+        ckpt_bytes(ck, &c->started, sizeof(c->started));
+        ckpt_u32(ck, &c->start_ms);
+        ckpt_u32(ck, &c->request_ms);
+        ckpt_u32(ck, &c->finish_ms);
+    }
+    ckpt_bytes(ck, &num_finished, sizeof(num_finished));
+
+    uint32_t responses = (uint32_t)num_responses;
+    ckpt_u32(ck, &responses);
+    if (ckpt_restoring(ck)) {
+        num_responses = 0;
+        for (uint32_t i = 0; i < responses; i++) {
+            uint32_t response_ms;
+            ckpt_u32(ck, &response_ms);
+            add_response(response_ms);
+        }
+    } else {
+        for (size_t i = 0; i < num_responses; i++) {
+            ckpt_u32(ck, &responses_ms[i]);
+        }
+    }
+}
@@ -0,0 +1,69 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "checkpoint.h"
+
+/*
+ * Deterministic replay of a scenario, without sockets and in virtual time.
+ * The scenario is one of the run_*.sh scripts: each "./app <name> <time_s>" and
+ * "./app-io <bursts.csv>" line becomes a virtual application, connected through the
+ * loopback mode of netio, that behaves like the real one (it sends its next
+ * request as soon as it receives DONE). "sleep <s>" lines delay the applications
+ * that follow. Since nothing depends on the wall clock, two replays of the same
+ * scenario with the same scheduler give exactly the same results.
+ */
+
+/**
+ * @brief Load the applications of a scenario script
+ *
+ * Relative burst files are searched from the current directory, then from the
+ * directory of the script.
+ *
+ * @param scenario_path The path of the script
+ * @return 0 on success, -1 on failure
+ */
+int replay_load(const char *scenario_path);
+
+/**
+ * @brief Start netio in loopback mode, connected to the virtual applications
+ *
+ * @return 0 on success, -1 on failure
+ */
+int replay_start(void);
+
+/**
+ * @brief Connect the applications whose start time was reached
+ *
+ * @param current_time_ms Current simulation time in milliseconds
+ */
+void replay_tick(uint32_t current_time_ms);
+
+/**
+ * @brief Check if all the applications finished and disconnected
+ */
+int replay_done(void);
+
+/**
+ * @brief Print the results of each application and the aggregate metrics
+ *
+ * The aggregates are the mean turnaround, the 99th percentile of the response
+ * time of the CPU bursts (from ACK to DONE) and the throughput in bursts per second.
+ *
+ * @param out            The stream where the results will be printed
+ * @param scheduler_name The name of the scheduler
+ */
+void replay_report(FILE *out, const char *scheduler_name);
+
+/**
+ * @brief Save or restore the progress of the virtual applications
+ *
+ * The same scenario must be loaded when restoring.
+ *
+ * @param ck The checkpoint
+ */
+void replay_checkpoint(checkpoint_t *ck);
+
+#endif // REPLAY_H
@@ -0,0 +1,418 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "debug.h"
+#include "metrics.h"
+#include "msg.h"
+#include "shard.h"
+#include "stats.h"
+#include "topology.h"
+
+/*
+ * Front-end router of a sharded simulator: starts several simulators (shards),
+ * each one simulating its own CPUs, accepts the applications on SOCKET_PATH and
+ * passes each connection to the least loaded shard (see shard.h). Periodically,
+ * the waiting tasks of a busy shard are moved to a shard with idle CPUs. The
+ * statistics of the shards are added up and served on STATS_SOCKET_PATH as the
+ * metrics of a single machine, whose sockets are the sockets of all the shards.
+ *
+ * Run like: ./router -n 4 -t 2:8:1 -- -p rr_quantum_ms=50 RR
+ * The arguments after -- are passed to every shard. The output of shard i goes
+ * to shard-i.log.
+ */
+
+#define MAX_SHARDS 64
+#define DEFAULT_BALANCE_MS 200
+
+typedef struct {
+    pid_t pid;
+    int ctl_fd;                     // Control socket (-1 when the shard is gone)
+    uint64_t ready;                 // Tasks waiting for a CPU, in the last report
+    uint64_t busy;                  // Busy CPUs, in the last report
+    uint32_t assigned;              // Tasks sent since the last report
+    int migrate_to;                 // Shard receiving the tasks released by this one (-1 if none)
+    uint64_t clients;               // Connections passed to the shard
+    uint64_t moved_in;              // Tasks received from other shards
+    uint64_t moved_out;             // Tasks given to other shards
+    uint64_t stats[SHARD_NUM_STATS];// Statistics in the last report
+} shard_t;
+
+// The statistics of all the shards, served by the metrics thread
+sim_stats_t sim_stats;
+
+static shard_t shards[MAX_SHARDS];
+static int num_shards = 2;
+static int shard_cpus = 0;          // CPUs of each shard
+static int next_shard = 0;          // Where the search for the least loaded shard starts (ties)
+
+static volatile sig_atomic_t running = 1;
+
+static void handle_stop_signal(int signum) {
+    (void)signum;
+    running = 0;
+}
+
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+}
+
+// Create a non-blocking listening UNIX socket
+static int listen_socket(const char *path) {
+    unlink(path);
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+    struct sockaddr_un addr = {0};
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(fd, SOMAXCONN) < 0) {
+        perror(path);
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Start a shard with one end of a control socket pair as its fd 3
+static int start_shard(int index, const char *scheduler, const char *topology, char **shard_args, int num_args) {
+    int pair[2];
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, pair) < 0) {
+        perror("socketpair");
+        return -1;
+    }
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        close(pair[0]);
+        close(pair[1]);
+        return -1;
+    }
+    if (pid == 0) {
+        char log[32];
+        snprintf(log, sizeof(log), "shard-%d.log", index);
+        int out = open(log, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (out >= 0) {
+            dup2(out, STDOUT_FILENO);
+            close(out);
+        }
+        // dup2 clears close-on-exec
+        dup2(pair[1], 3);
+        char *args[num_args + 6];
+        int n = 0;
+        args[n++] = (char *)scheduler;
+        args[n++] = "-t";
+        args[n++] = (char *)topology;
+        args[n++] = "-x";
+        args[n++] = "3";
+        for (int i = 0; i < num_args; i++) args[n++] = shard_args[i];
+        args[n] = NULL;
+        execv(scheduler, args);
+        perror("execv");
+        _exit(127);
+    }
+    close(pair[1]);
+    shards[index] = (shard_t){.pid = pid, .ctl_fd = pair[0], .migrate_to = -1};
+    return 0;
+}
+
+// Least loaded live shard (tasks running, waiting, and sent since its last report)
+static int least_loaded_shard(void) {
+    int best = -1;
+    uint64_t best_load = UINT64_MAX;
+    for (int k = 0; k < num_shards; k++) {
+        int i = (next_shard + k) % num_shards;
+        if (shards[i].ctl_fd < 0) continue;
+        uint64_t load = shards[i].busy + shards[i].ready + shards[i].assigned;
+        if (load < best_load) {
+            best = i;
+            best_load = load;
+        }
+    }
+    next_shard = (next_shard + 1) % num_shards;
+    return best;
+}
+
+// Pass a connection (and the request of a moved task) to a shard
+static void send_client(int shard, int fd, const shard_msg_t *handoff) {
+    if (shard < 0 || shard_send(shards[shard].ctl_fd, handoff, fd) != 0) {
+        fprintf(stderr, "No shard for the connection, closing it\n");
+    } else {
+        shards[shard].assigned++;
+        shards[shard].clients++;
+    }
+    close(fd);
+}
+
+static void accept_clients(int listen_fd) {
+    while (1) {
+        int fd = accept(listen_fd, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) perror("accept");
+            return;
+        }
+        // Not inherited by the shards started later
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+        shard_msg_t handoff = {.type = SHARD_CLIENT};
+        int shard = least_loaded_shard();
+        DBG("[Router] New client fd=%d to shard %d\n", fd, shard);
+        send_client(shard, fd, &handoff);
+    }
+}
+
+// Add up the statistics of the shards; the CPUs of shard i follow those of shard i-1
+static void aggregate_stats(void) {
+    const size_t busy_base = offsetof(sim_stats_t, cpu_busy_ms) / sizeof(stat_t);
+    const size_t idle_base = offsetof(sim_stats_t, cpu_idle_ms) / sizeof(stat_t);
+    const size_t time_index = offsetof(sim_stats_t, sim_time_ms) / sizeof(stat_t);
+    stat_t *total = (stat_t *)&sim_stats;
+
+    for (size_t k = 0; k < SHARD_NUM_STATS; k++) {
+        if ((k >= busy_base && k < busy_base + MAX_CPUS) || (k >= idle_base && k < idle_base + MAX_CPUS)) {
+            size_t base = (k < idle_base) ? busy_base : idle_base;
+            size_t cpu = k - base;
+            size_t shard = cpu / (size_t)shard_cpus;
+            uint64_t value = shard < (size_t)num_shards ? shards[shard].stats[base + cpu % (size_t)shard_cpus] : 0;
+            atomic_store_explicit(&total[k], value, memory_order_relaxed);
+            continue;
+        }
+        uint64_t value = 0;
+        for (int i = 0; i < num_shards; i++) {
+            // The clocks of the shards are independent, the machine is as old as the oldest one
+            if (k == time_index) {
+                if (shards[i].stats[k] > value) value = shards[i].stats[k];
+            } else {
+                value += shards[i].stats[k];
+            }
+        }
+        atomic_store_explicit(&total[k], value, memory_order_relaxed);
+    }
+}
+
+static void read_control(int index) {
+    static shard_msg_t msg;
+    shard_t *s = &shards[index];
+    int fd;
+    int ret = shard_recv(s->ctl_fd, &msg, &fd);
+    if (ret <= 0) {
+        fprintf(stderr, "Shard %d (PID %d) stopped\n", index, s->pid);
+        close(s->ctl_fd);
+        s->ctl_fd = -1;
+        return;
+    }
+    if (msg.type == SHARD_REPORT) {
+        memcpy(s->stats, msg.stats, sizeof(s->stats));
+        s->ready = SHARD_STAT(&msg, ready_queue_len);
+        s->busy = SHARD_STAT(&msg, busy_cpus);
+        s->assigned = 0;
+        aggregate_stats();
+    } else if (msg.type == SHARD_CLIENT && fd >= 0) {
+        // A task released by the shard, for the shard chosen when it was asked to
+        int to = s->migrate_to;
+        if (to < 0 || shards[to].ctl_fd < 0) to = least_loaded_shard();
+        s->moved_out++;
+        if (to >= 0) shards[to].moved_in++;
+        DBG("[Router] Task %d moved from shard %d to shard %d\n", msg.task.request.pid, index, to);
+        send_client(to, fd, &msg);
+    } else if (fd >= 0) {
+        close(fd);
+    }
+}
+
+// Move waiting tasks from the busiest shard to the shard with the most idle CPUs
+static void balance(void) {
+    int src = -1, dst = -1;
+    uint64_t most_waiting = 0;
+    int64_t most_idle = 0;
+    for (int i = 0; i < num_shards; i++) {
+        if (shards[i].ctl_fd < 0) continue;
+        if (shards[i].ready > most_waiting) {
+            src = i;
+            most_waiting = shards[i].ready;
+        }
+        int64_t idle = (int64_t)shard_cpus - (int64_t)shards[i].busy - (int64_t)shards[i].assigned;
+        if (shards[i].ready == 0 && idle > most_idle) {
+            dst = i;
+            most_idle = idle;
+        }
+    }
+    if (src < 0 || dst < 0) return;
+
+    // Half of the waiting tasks at most, so the two shards do not swap their load
+    uint32_t count = (uint32_t)((most_waiting + 1) / 2);
+    if (count > (uint64_t)most_idle) count = (uint32_t)most_idle;
+    shard_msg_t release = {.type = SHARD_RELEASE, .count = count};
+    if (shard_send(shards[src].ctl_fd, &release, -1) == 0) {
+        shards[src].migrate_to = dst;
+        shards[src].ready -= count;     // Until the next report
+        shards[dst].assigned += count;
+        DBG("[Router] Moving %u tasks from shard %d to shard %d\n", count, src, dst);
+    }
+}
+
+static void print_summary(FILE *out) {
+    uint64_t busy_ms = 0, total_ms = 0;
+    for (int i = 0; i < topo_num_cpus(); i++) {
+        busy_ms += STAT_GET(cpu_busy_ms[i]);
+        total_ms += STAT_GET(cpu_busy_ms[i]) + STAT_GET(cpu_idle_ms[i]);
+    }
+    fprintf(out, "Router summary (%d shards of %d CPUs):\n", num_shards, shard_cpus);
+    for (int i = 0; i < num_shards; i++) {
+        fprintf(out, "  Shard %d (PID %d): %" PRIu64 " connections, %" PRIu64 " tasks moved in, %"
+                PRIu64 " moved out, see shard-%d.log\n",
+                i, shards[i].pid, shards[i].clients, shards[i].moved_in, shards[i].moved_out, i);
+    }
+    fprintf(out, "  Simulated time:    %" PRIu64 " ms\n", STAT_GET(sim_time_ms));
+    fprintf(out, "  Dispatches:        %" PRIu64 "\n", STAT_GET(dispatches));
+    fprintf(out, "  Preemptions:       %" PRIu64 "\n", STAT_GET(preemptions));
+    fprintf(out, "  Messages in/out:   %" PRIu64 "/%" PRIu64 "\n", STAT_GET(messages_in), STAT_GET(messages_out));
+    fprintf(out, "  CPU utilization:   %.2f%%\n", total_ms ? 100.0 * (double)busy_ms / (double)total_ms : 0.0);
+}
+
+// A positive number up to max, or exit
+static long parse_positive(const char *arg, char opt, long max) {
+    char *endptr;
+    errno = 0;
+    long value = strtol(arg, &endptr, 10);
+    if (errno != 0 || endptr == arg || *endptr != '\0' || value <= 0 || value > max) {
+        fprintf(stderr, "Invalid value for -%c: %s (expected 1 to %ld)\n", opt, arg, max);
+        exit(EXIT_FAILURE);
+    }
+    return value;
+}
+
+static void print_usage(const char *prog) {
+    printf("Usage: %s [-x scheduler] [-n shards] [-t sockets:cores:threads] [-b balance_ms] "
+           "-- [scheduler options...] <scheduler>\n"
+           "The topology is the one of each shard (default 2:2:1)\n", prog);
+}
+
+int main(int argc, char *argv[]) {
+    char scheduler[PATH_MAX];
+    const char *slash = strrchr(argv[0], '/');
+    snprintf(scheduler, sizeof(scheduler), "%.*sscheduler", slash ? (int)(slash - argv[0] + 1) : 0, argv[0]);
+    const char *topology = "2:2:1";
+    long balance_ms = DEFAULT_BALANCE_MS;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "x:n:t:b:")) != -1) {
+        switch (opt) {
+            case 'x':
+                snprintf(scheduler, sizeof(scheduler), "%s", optarg);
+                break;
+            case 'n':
+                num_shards = (int)parse_positive(optarg, 'n', MAX_SHARDS);
+                break;
+            case 't':
+                topology = optarg;
+                break;
+            case 'b':
+                balance_ms = parse_positive(optarg, 'b', INT_MAX);
+                break;
+            default:
+                print_usage(argv[0]);
+                exit(EXIT_FAILURE);
+        }
+    }
+    if (optind >= argc || num_shards < 1 || num_shards > MAX_SHARDS || balance_ms <= 0) {
+        print_usage(argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    // The machine seen by the metrics has the sockets of all the shards
+    int s, c, t;
+    if (topo_configure(topology) != 0 || sscanf(topology, "%d:%d:%d", &s, &c, &t) != 3) {
+        exit(EXIT_FAILURE);
+    }
+    shard_cpus = topo_num_cpus();
+    char machine[64];
+    snprintf(machine, sizeof(machine), "%d:%d:%d", s * num_shards, c, t);
+    if (topo_configure(machine) != 0) {
+        exit(EXIT_FAILURE);
+    }
+
+    struct sigaction sa = {0};
+    sa.sa_handler = handle_stop_signal;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    int listen_fd = listen_socket(SOCKET_PATH);
+    if (listen_fd < 0) {
+        return EXIT_FAILURE;
+    }
+    for (int i = 0; i < num_shards; i++) {
+        if (start_shard(i, scheduler, topology, &argv[optind], argc - optind) != 0) {
+            num_shards = i;
+            running = 0;
+            break;
+        }
+    }
+    int stats_fd = listen_socket(STATS_SOCKET_PATH);
+    if (stats_fd >= 0 && metrics_start(stats_fd) != 0) {
+        close(stats_fd);
+        stats_fd = -1;
+    }
+    printf("Router listening on %s with %d shards of %d CPUs (%d CPUs)\n",
+           SOCKET_PATH, num_shards, shard_cpus, topo_num_cpus());
+
+    struct pollfd fds[MAX_SHARDS + 1];
+    uint64_t next_balance_ms = now_ms() + (uint64_t)balance_ms;
+    while (running) {
+        fds[0] = (struct pollfd){.fd = listen_fd, .events = POLLIN};
+        for (int i = 0; i < num_shards; i++) {
+            fds[i + 1] = (struct pollfd){.fd = shards[i].ctl_fd, .events = POLLIN};
+        }
+        uint64_t now = now_ms();
+        int timeout = now < next_balance_ms ? (int)(next_balance_ms - now) : 0;
+        int ready = poll(fds, (nfds_t)num_shards + 1, timeout);
+        if (ready < 0 && errno != EINTR) {
+            perror("poll");
+            break;
+        }
+        for (int i = 0; ready > 0 && i < num_shards; i++) {
+            if (fds[i + 1].revents != 0) read_control(i);
+        }
+        if (ready > 0 && (fds[0].revents & POLLIN)) {
+            accept_clients(listen_fd);
+        }
+        if (now_ms() >= next_balance_ms) {
+            balance();
+            next_balance_ms = now_ms() + (uint64_t)balance_ms;
+        }
+    }
+
+    // The shards print their statistics when they stop
+    close(listen_fd);
+    unlink(SOCKET_PATH);
+    for (int i = 0; i < num_shards; i++) {
+        kill(shards[i].pid, SIGTERM);
+    }
+    for (int i = 0; i < num_shards; i++) {
+        waitpid(shards[i].pid, NULL, 0);
+        if (shards[i].ctl_fd >= 0) close(shards[i].ctl_fd);
+    }
+    if (stats_fd >= 0) {
+        metrics_stop();
+        close(stats_fd);
+        unlink(STATS_SOCKET_PATH);
+    }
+    print_summary(stdout);
+    return 0;
+}
@@ -7,12 +7,33 @@
 #include <unistd.h>
 
 #include "queue.h"
+#include "cpu.h"
 #include "debug.h"
+#include "params.h"
+#include "probes.h"
+#include "stats.h"
 
-void rr_scheduler(uint32_t current_time_ms,
-                  queue_t *ready_queue,
-                  pcb_t **cpus,
-                  int num_cpus) {
+// Fatia do RR-ADAPT para uma tarefa colocada agora: o período alvo dividido pelas
+// tarefas prontas por CPU (arredondado para cima), com a fatia mínima como limite
+static uint32_t adaptive_slice_ms(const queue_t *ready_queue, pcb_t **cpus, int num_cpus) {
+    int runnable = ready_queue->size;
+    for (int i = 0; i < num_cpus; i++) {
+        if (cpus[i] != NULL) runnable++;
+    }
+    int per_cpu = (runnable + num_cpus - 1) / num_cpus;
+    if (per_cpu < 1) per_cpu = 1;
+    uint32_t slice_ms = sim_params.rr_latency_ms / (uint32_t)per_cpu;
+    if (slice_ms < sim_params.rr_min_granularity_ms) slice_ms = sim_params.rr_min_granularity_ms;
+    STAT_ADD(rr_slices, 1);
+    STAT_ADD(rr_slice_ms, slice_ms);
+    return slice_ms;
+}
+
+static void rr_run(uint32_t current_time_ms,
+                   queue_t *ready_queue,
+                   pcb_t **cpus,
+                   int num_cpus,
+                   int adaptive) {
     int i;
 
     // 1. Atualiza todos os processos que estão a correr nas CPUs
@@ -20,47 +41,68 @@ void rr_scheduler(uint32_t current_time_ms,
         pcb_t *p = cpus[i];
         if (p == NULL) continue;
 
-        p->ellapsed_time_ms += TICKS_MS;
+        p->ellapsed_time_ms += cpu_run_tick(cpus, i);
 
         // Terminou o burst?
         if (p->ellapsed_time_ms >= p->time_ms) {
             DBG("Process %d finished CPU burst on CPU %d\n", p->pid, i);
-
-            msg_t done_msg = {
-                .pid = p->pid,
-                .request = PROCESS_REQUEST_DONE,
-                .time_ms = current_time_ms
-            };
-            write(p->sockfd, &done_msg, sizeof(msg_t));
-
-            p->status = TASK_COMMAND;
-            p->ellapsed_time_ms = 0;
-            cpus[i] = NULL;
+            cpu_burst_done(cpus, i, current_time_ms);
             continue;
         }
 
         // Preempção por quantum?
-        if (p->ellapsed_time_ms >= QUANTUM_MS) {
+        uint32_t quantum_ms = adaptive ? p->slice_ms : sim_params.rr_quantum_ms;
+        if (p->ellapsed_time_ms >= quantum_ms) {
+            // RR-ADAPT: sem tarefas à espera, a tarefa continua com uma nova fatia
+            if (adaptive && ready_queue->head == NULL) {
+                p->slice_ms = p->ellapsed_time_ms + adaptive_slice_ms(ready_queue, cpus, num_cpus);
+                STAT_ADD(rr_slice_renewals, 1);
+                continue;
+            }
             DBG("Process %d preempted on CPU %d (quantum expired)\n", p->pid, i);
+            PROBE4(preempt_quantum, p->pid, i, 0, current_time_ms);
 
             p->time_ms -= p->ellapsed_time_ms;
             p->ellapsed_time_ms = 0;
             p->status = TASK_RUNNING;
             enqueue_pcb(ready_queue, p);
             cpus[i] = NULL;
+            STAT_ADD(preemptions, 1);
         }
     }
 
     // 2. Coloca processos da ready_queue nas CPUs livres
-    for (i = 0; i < num_cpus; i++) {
-        if (cpus[i] != NULL) continue;
-        if (ready_queue->head == NULL) break;
+    queue_elem_t *elem = ready_queue->head;
+    while (elem != NULL && cpu_first_free(cpus, num_cpus) >= 0) {
+        pcb_t *next = elem->pcb;
+        int cpu = cpu_select(next, cpus, num_cpus);
+        if (cpu < 0) {
+            elem = elem->next;  // Espera pela CPU anterior (ou não há CPUs livres)
+            continue;
+        }
 
-        pcb_t *next = dequeue_pcb(ready_queue);
-        next->status = TASK_RUNNING;
-        next->ellapsed_time_ms = 0;
-        cpus[i] = next;
+        queue_elem_t *tmp = elem;
+        elem = elem->next;
+        // A fatia conta com a tarefa que vai ser colocada (ainda na ready queue)
+        if (adaptive) next->slice_ms = adaptive_slice_ms(ready_queue, cpus, num_cpus);
+        remove_queue_elem(ready_queue, tmp);
+        free(tmp);
+        cpu_dispatch(next, cpus, cpu, current_time_ms);
 
-        DBG("Process %d started on CPU %d (RR)\n", next->pid, i);
+        DBG("Process %d started on CPU %d (%s)\n", next->pid, cpu, adaptive ? "RR-ADAPT" : "RR");
     }
+}
+
+void rr_scheduler(uint32_t current_time_ms,
+                  queue_t *ready_queue,
+                  pcb_t **cpus,
+                  int num_cpus) {
+    rr_run(current_time_ms, ready_queue, cpus, num_cpus, 0);
+}
+
+void rr_adapt_scheduler(uint32_t current_time_ms,
+                        queue_t *ready_queue,
+                        pcb_t **cpus,
+                        int num_cpus) {
+    rr_run(current_time_ms, ready_queue, cpus, num_cpus, 1);
 }
\ No newline at end of file
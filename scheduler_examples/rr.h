@@ -4,7 +4,9 @@
 #include <stdint.h>
 #include "queue.h"
 
-#define QUANTUM_MS 100
+#define QUANTUM_MS 100  // Quantum por omissão (parâmetro rr_quantum_ms)
+#define RR_LATENCY_MS 200           // Período alvo do RR-ADAPT (parâmetro rr_latency_ms)
+#define RR_MIN_GRANULARITY_MS 20    // Fatia mínima do RR-ADAPT (parâmetro rr_min_granularity_ms)
 
 /**
  * @brief Round-Robin scheduler com suporte a múltiplos CPUs
@@ -19,4 +21,25 @@ void rr_scheduler(uint32_t current_time_ms,
                   pcb_t **cpus,
                   int num_cpus);
 
+/**
+ * @brief Round-Robin com fatia de tempo adaptativa (RR-ADAPT)
+ *
+ * Em vez de um quantum fixo, cada tarefa recebe, quando é colocada numa CPU, uma
+ * fatia igual ao período alvo (rr_latency_ms) dividido pelo número de tarefas
+ * prontas por CPU nesse momento (as que estão a correr e as da ready queue), mas
+ * nunca menor do que rr_min_granularity_ms. Com poucas tarefas as fatias são longas
+ * e há menos trocas de contexto; com muitas, cada tarefa volta a correr ao fim de
+ * cerca de rr_latency_ms até a fatia mínima ser atingida. Quando a fatia acaba e
+ * não há nenhuma tarefa à espera, a tarefa continua com uma nova fatia.
+ *
+ * @param current_time_ms Tempo atual da simulação em ms
+ * @param ready_queue     Fila de processos prontos
+ * @param cpus            Array de ponteiros para os processos em execução (um por CPU)
+ * @param num_cpus        Número de CPUs disponíveis
+ */
+void rr_adapt_scheduler(uint32_t current_time_ms,
+                        queue_t *ready_queue,
+                        pcb_t **cpus,
+                        int num_cpus);
+
 #endif // RR_H
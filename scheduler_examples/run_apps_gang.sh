@@ -0,0 +1,11 @@
+#!/bin/bash
+# This script runs parallel and serial applications in the background.
+# The third argument of ./app is the number of CPUs the application needs at the same time.
+./app P1 4 2 &
+./app S1 3 &
+./app P2 2 4 &
+./app S2 1 &
+./app S3 6 &
+sleep 1
+./app P3 3 3 &
+./app S4 2 &
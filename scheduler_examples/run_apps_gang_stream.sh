@@ -0,0 +1,48 @@
+#!/bin/bash
+# A wide parallel application arrives while short serial applications keep arriving.
+# Without a reservation, the serial applications would keep a CPU busy and starve P1.
+./app S1 2 &
+./app S2 2 &
+sleep 0.5
+./app P1 2 4 &
+sleep 0.5
+./app S3 2 &
+sleep 0.5
+./app S4 2 &
+sleep 0.5
+./app S5 2 &
+sleep 0.5
+./app S6 2 &
+sleep 0.5
+./app S7 2 &
+sleep 0.5
+./app S8 2 &
+sleep 0.5
+./app S9 2 &
+sleep 0.5
+./app S10 2 &
+sleep 0.5
+./app S11 2 &
+sleep 0.5
+./app S12 2 &
+sleep 0.5
+./app S13 2 &
+sleep 0.5
+./app S14 2 &
+sleep 0.5
+./app S15 2 &
+sleep 0.5
+./app S16 2 &
+sleep 0.5
+./app S17 2 &
+sleep 0.5
+./app S18 2 &
+sleep 0.5
+./app S19 2 &
+sleep 0.5
+./app S20 2 &
+sleep 0.5
+./app S21 2 &
+sleep 0.5
+./app S22 2 &
+wait
@@ -0,0 +1,13 @@
+#!/bin/bash
+# Two tenants share the simulator: "batch" floods it with six CPU-bound applications,
+# while "web" runs two applications. Run with the FAIR scheduler to divide the CPU
+# time by group instead of by task (e.g. -w web=2 gives web twice the share of batch).
+OSSIM_GROUP=batch ./app A 5 &
+OSSIM_GROUP=batch ./app B 10 &
+OSSIM_GROUP=batch ./app C 4 &
+OSSIM_GROUP=batch ./app D 2 &
+OSSIM_GROUP=batch ./app E 3 &
+OSSIM_GROUP=batch ./app F 15 &
+OSSIM_GROUP=web ./app-io ../C-5.csv &
+OSSIM_GROUP=web ./app W 20 &
+wait
@@ -0,0 +1,75 @@
+#include "shard.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+
+int shard_send(int ctl_fd, const shard_msg_t *msg, int fd) {
+    struct iovec iov = {.iov_base = (void *)msg, .iov_len = sizeof(*msg)};
+    union {
+        char buf[CMSG_SPACE(sizeof(int))];
+        struct cmsghdr align;
+    } control;
+    struct msghdr hdr = {.msg_iov = &iov, .msg_iovlen = 1};
+    if (fd >= 0) {
+        memset(&control, 0, sizeof(control));
+        hdr.msg_control = control.buf;
+        hdr.msg_controllen = sizeof(control.buf);
+        struct cmsghdr *cmsg = CMSG_FIRSTHDR(&hdr);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+    }
+    ssize_t n;
+    do {
+        n = sendmsg(ctl_fd, &hdr, MSG_NOSIGNAL);
+    } while (n < 0 && errno == EINTR);
+    if (n != (ssize_t)sizeof(*msg)) {
+        perror("sendmsg");
+        return -1;
+    }
+    return 0;
+}
+
+int shard_recv(int ctl_fd, shard_msg_t *msg, int *fd) {
+    struct iovec iov = {.iov_base = msg, .iov_len = sizeof(*msg)};
+    union {
+        char buf[CMSG_SPACE(sizeof(int))];
+        struct cmsghdr align;
+    } control;
+    struct msghdr hdr = {
+        .msg_iov = &iov,
+        .msg_iovlen = 1,
+        .msg_control = control.buf,
+        .msg_controllen = sizeof(control.buf),
+    };
+    *fd = -1;
+    ssize_t n;
+    do {
+        n = recvmsg(ctl_fd, &hdr, MSG_CMSG_CLOEXEC);
+    } while (n < 0 && errno == EINTR);
+    if (n == 0) return 0;
+    if (n < 0) {
+        perror("recvmsg");
+        return -1;
+    }
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&hdr); cmsg != NULL; cmsg = CMSG_NXTHDR(&hdr, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+            memcpy(fd, CMSG_DATA(cmsg), sizeof(int));
+        }
+    }
+    if (n != (ssize_t)sizeof(*msg)) {
+        fprintf(stderr, "Truncated message on the control socket (%zd bytes)\n", n);
+        return -1;
+    }
+    return 1;
+}
+
+void shard_snapshot(uint64_t *stats) {
+    stat_t *counters = (stat_t *)&sim_stats;
+    for (size_t i = 0; i < SHARD_NUM_STATS; i++) {
+        stats[i] = atomic_load_explicit(&counters[i], memory_order_relaxed);
+    }
+}
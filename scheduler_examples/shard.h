@@ -0,0 +1,80 @@
+#ifndef SHARD_H
+#define SHARD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "msg.h"
+#include "stats.h"
+
+/*
+ * Protocol between the router and the simulator shards.
+ * Each shard is a simulator started by the router with one end of a
+ * SOCK_SEQPACKET socket pair as its control socket (option -x). The router
+ * accepts the applications on SOCKET_PATH and passes each connection to a shard
+ * with SCM_RIGHTS, so the messages of the applications go directly to the shard
+ * and never through the router. The shards report their load and statistics on
+ * the control socket, and the router asks the busy shards to give back some of
+ * their waiting tasks, which it passes to the idle shards.
+ */
+
+// Number of counters in a report (the statistics are a struct of stat_t)
+#define SHARD_NUM_STATS (sizeof(sim_stats_t) / sizeof(stat_t))
+
+// Time between two reports of a shard
+#define SHARD_REPORT_MS 100
+
+typedef enum {
+    SHARD_CLIENT = 0,   // A connection (attached), in both directions
+    SHARD_RELEASE,      // Router -> shard: give back up to count waiting tasks
+    SHARD_REPORT,       // Shard -> router: load and statistics
+} shard_msg_type_en;
+
+// A task moved between shards. The clocks of the shards are independent, so the task
+// brings the time of the application's clock (the clock of the shard that acknowledged
+// its requests), and the new shard translates the times it sends to that clock.
+typedef struct {
+    msg_t request;                      // The RUN request, with the remaining time
+    uint32_t client_time_ms;            // Time of the application's clock when the task left
+    uint32_t waited_ms;                 // Time since the RUN request was acknowledged
+} shard_task_t;
+
+typedef struct {
+    shard_msg_type_en type;
+    uint32_t count;                     // SHARD_RELEASE: number of tasks
+    uint32_t has_request;               // SHARD_CLIENT: the task has a RUN request in progress
+    shard_task_t task;                  // SHARD_CLIENT: the task and its RUN request
+    uint64_t stats[SHARD_NUM_STATS];    // SHARD_REPORT: snapshot of sim_stats
+} shard_msg_t;
+
+// Value of a field of sim_stats in a report
+#define SHARD_STAT(msg, field) ((msg)->stats[offsetof(sim_stats_t, field) / sizeof(stat_t)])
+
+/**
+ * @brief Send a message on a control socket, optionally with a file descriptor
+ *
+ * @param ctl_fd The control socket
+ * @param msg    The message
+ * @param fd     The file descriptor to pass, or -1
+ * @return 0 on success, -1 on failure
+ */
+int shard_send(int ctl_fd, const shard_msg_t *msg, int fd);
+
+/**
+ * @brief Receive a message from a control socket
+ *
+ * @param ctl_fd The control socket
+ * @param msg    Where the message is stored
+ * @param fd     Where the passed file descriptor is stored (-1 if there is none)
+ * @return 1 if a message was received, 0 if the other side closed the socket, -1 on failure
+ */
+int shard_recv(int ctl_fd, shard_msg_t *msg, int *fd);
+
+/**
+ * @brief Take a snapshot of the statistics of this process
+ *
+ * @param stats Where the SHARD_NUM_STATS counters are stored
+ */
+void shard_snapshot(uint64_t *stats);
+
+#endif // SHARD_H
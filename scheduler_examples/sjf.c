@@ -4,25 +4,60 @@
 #include <stdlib.h>
 #include <unistd.h>
 
+#include "cpu.h"
 #include "debug.h"
+#include "probes.h"
 #include "msg.h"
+#include "params.h"
 #include "queue.h"
+#include "stats.h"
+
+// Duração (restante) do burst usada para ordenar os jobs:
+// - SJF: o tempo declarado no pedido RUN (oráculo)
+// - SJF-EXP: a previsão por média exponencial, menos o tempo que o job já correu neste burst
+static uint32_t job_length(const pcb_t *p, int predict) {
+    if (!predict) {
+        return cpu_remaining_ms(p);
+    }
+    uint32_t predicted = p->predicted_ms ? p->predicted_ms : sim_params.sjf_initial_guess_ms;
+    return (predicted > p->burst_run_ms) ? predicted - p->burst_run_ms : 0;
+}
+
+// Atualiza a previsão com a duração real do burst que terminou:
+// tau(n+1) = alpha * t(n) + (1 - alpha) * tau(n)
+static void update_prediction(pcb_t *p) {
+    uint32_t predicted = p->predicted_ms ? p->predicted_ms : sim_params.sjf_initial_guess_ms;
+    uint32_t actual = p->burst_ms;
+    uint32_t alpha = (sim_params.sjf_alpha_pct < 100) ? sim_params.sjf_alpha_pct : 100;
+
+    STAT_ADD(predicted_bursts, 1);
+    STAT_ADD(prediction_error_ms, (actual > predicted) ? actual - predicted : predicted - actual);
+    STAT_ADD(predicted_burst_ms, actual);
+
+    p->predicted_ms = (uint32_t)(((uint64_t)alpha * actual + (uint64_t)(100 - alpha) * predicted) / 100);
+    if (p->predicted_ms == 0) p->predicted_ms = 1;  // 0 significa "sem histórico"
+    DBG("SJF-EXP: Process %d burst of %u ms (predicted %u ms), next prediction %u ms\n",
+        p->pid, actual, predicted, p->predicted_ms);
+}
 
 // Função auxiliar: encontra o elemento com o job mais curto na fila
-static queue_elem_t* find_shortest_job_elem(queue_t *rq) {
+// Ignora os jobs que estão à espera de ficar livre a CPU onde correram antes
+static queue_elem_t* find_shortest_job_elem(queue_t *rq, pcb_t **cpus, int num_cpus, int predict) {
     if (rq == NULL || rq->head == NULL) {
         return NULL;
     }
 
-    queue_elem_t *shortest_elem = rq->head;
-    queue_elem_t *current_elem = rq->head->next;
-    uint32_t shortest_time = shortest_elem->pcb->time_ms;
+    queue_elem_t *shortest_elem = NULL;
+    queue_elem_t *current_elem = rq->head;
+    uint32_t shortest_time = UINT32_MAX;
 
     // Percorre a fila para encontrar o trabalho mais curto
     while (current_elem != NULL) {
-        if (current_elem->pcb->time_ms < shortest_time) {
+        uint32_t length = job_length(current_elem->pcb, predict);
+        if ((shortest_elem == NULL || length < shortest_time) &&
+            cpu_select(current_elem->pcb, cpus, num_cpus) >= 0) {
             shortest_elem = current_elem;
-            shortest_time = current_elem->pcb->time_ms;
+            shortest_time = length;
         }
         current_elem = current_elem->next;
     }
@@ -31,8 +66,8 @@ static queue_elem_t* find_shortest_job_elem(queue_t *rq) {
 }
 
 // Função auxiliar: encontra e remove o job mais curto da fila
-static pcb_t* dequeue_shortest_job(queue_t *rq) {
-    queue_elem_t *shortest_elem = find_shortest_job_elem(rq);
+static pcb_t* dequeue_shortest_job(queue_t *rq, pcb_t **cpus, int num_cpus, int predict) {
+    queue_elem_t *shortest_elem = find_shortest_job_elem(rq, cpus, num_cpus, predict);
     if (shortest_elem == NULL) {
         return NULL;
     }
@@ -45,7 +80,7 @@ static pcb_t* dequeue_shortest_job(queue_t *rq) {
 }
 
 // Função auxiliar: encontra o processo mais curto na fila (para preempção)
-static pcb_t* find_shortest_in_queue(queue_t *rq, uint32_t *shortest_time) {
+static pcb_t* find_shortest_in_queue(queue_t *rq, uint32_t *shortest_time, int predict) {
     if (rq->head == NULL) {
         *shortest_time = UINT32_MAX;
         return NULL;
@@ -56,8 +91,9 @@ static pcb_t* find_shortest_in_queue(queue_t *rq, uint32_t *shortest_time) {
     uint32_t min_time = UINT32_MAX;
 
     while (elem != NULL) {
-        if (elem->pcb->time_ms < min_time) {
-            min_time = elem->pcb->time_ms;
+        uint32_t length = job_length(elem->pcb, predict);
+        if (length < min_time) {
+            min_time = length;
             shortest_pcb = elem->pcb;
         }
         elem = elem->next;
@@ -78,6 +114,7 @@ static void remove_specific_pcb(queue_t *rq, pcb_t *pcb) {
         if (rq->head == NULL) {
             rq->tail = NULL;
         }
+        rq->size--;
         free(to_remove);
         return;
     }
@@ -92,6 +129,7 @@ static void remove_specific_pcb(queue_t *rq, pcb_t *pcb) {
             if (current == rq->tail) {
                 rq->tail = prev;
             }
+            rq->size--;
             free(current);
             return;
         }
@@ -100,8 +138,8 @@ static void remove_specific_pcb(queue_t *rq, pcb_t *pcb) {
     }
 }
 
-// SJF com suporte a múltiplas CPUs e preempção
-void sjf_scheduler(uint32_t current_time_ms, queue_t *rq, pcb_t **cpus, int num_cpus) {
+// SJF com suporte a múltiplas CPUs e preempção, com a duração declarada ou prevista
+static void sjf_schedule(uint32_t current_time_ms, queue_t *rq, pcb_t **cpus, int num_cpus, int predict) {
     int i;
 
     // 1. Atualiza todos os processos que estão a correr nas CPUs
@@ -109,28 +147,18 @@ void sjf_scheduler(uint32_t current_time_ms, queue_t *rq, pcb_t **cpus, int num_
         pcb_t *p = cpus[i];
         if (p == NULL) continue;
 
-        p->ellapsed_time_ms += TICKS_MS;
+        uint32_t progress_ms = cpu_run_tick(cpus, i);
+        p->ellapsed_time_ms += progress_ms;
+        p->burst_run_ms += progress_ms;
 
         // Verifica se a tarefa atual terminou
         if (p->ellapsed_time_ms >= p->time_ms) {
             DBG("SJF: Process %d finished execution on CPU %d at time %d ms\n",
                 p->pid, i, current_time_ms);
+            if (predict) update_prediction(p);
 
             // Tarefa finalizada - envia mensagem DONE para a aplicação
-            msg_t msg = {
-                .pid = p->pid,
-                .request = PROCESS_REQUEST_DONE,
-                .time_ms = current_time_ms
-            };
-
-            if (write(p->sockfd, &msg, sizeof(msg_t)) != sizeof(msg_t)) {
-                perror("write");
-            }
-
-            // Atualiza estado
-            p->status = TASK_COMMAND;
-            p->ellapsed_time_ms = 0;
-            cpus[i] = NULL;
+            cpu_burst_done(cpus, i, current_time_ms);
         }
     }
 
@@ -141,31 +169,32 @@ void sjf_scheduler(uint32_t current_time_ms, queue_t *rq, pcb_t **cpus, int num_
         pcb_t *current = cpus[i];
         if (current == NULL) continue;
 
-        // Calcula tempo restante do processo atual
-        uint32_t remaining_time = current->time_ms - current->ellapsed_time_ms;
+        // Calcula tempo restante (declarado ou previsto) do processo atual
+        uint32_t remaining_time = job_length(current, predict);
 
         // Encontra o processo mais curto na ready queue
         uint32_t shortest_in_queue_time;
-        pcb_t *shortest_in_queue = find_shortest_in_queue(rq, &shortest_in_queue_time);
+        pcb_t *shortest_in_queue = find_shortest_in_queue(rq, &shortest_in_queue_time, predict);
 
         // Se houver um processo mais curto na fila que o tempo restante do atual
         if (shortest_in_queue != NULL && shortest_in_queue_time < remaining_time) {
             DBG("SJF: Process %d preempted by shorter process %d on CPU %d\n",
                 current->pid, shortest_in_queue->pid, i);
+            PROBE4(preempt_sjf, current->pid, shortest_in_queue->pid, i, current_time_ms);
 
             // Remove o processo mais curto da fila
             remove_specific_pcb(rq, shortest_in_queue);
 
             // Coloca o processo atual de volta na fila
-            current->time_ms = remaining_time; // Atualiza tempo restante
+            current->time_ms = cpu_remaining_ms(current); // Atualiza tempo restante (real)
             current->ellapsed_time_ms = 0;
             current->status = TASK_RUNNING;
             enqueue_pcb(rq, current);
+            STAT_ADD(preemptions, 1);
 
             // Coloca o processo mais curto na CPU
-            shortest_in_queue->status = TASK_RUNNING;
-            shortest_in_queue->ellapsed_time_ms = 0;
-            cpus[i] = shortest_in_queue;
+            cpus[i] = NULL;
+            cpu_dispatch(shortest_in_queue, cpus, i, current_time_ms);
 
             DBG("SJF: Process %d started on CPU %d (preempted %d)\n",
                 shortest_in_queue->pid, i, current->pid);
@@ -173,21 +202,26 @@ void sjf_scheduler(uint32_t current_time_ms, queue_t *rq, pcb_t **cpus, int num_
     }
 
     // 3. Preencher CPUs livres com jobs mais curtos
-    for (i = 0; i < num_cpus; i++) {
-        if (cpus[i] != NULL) continue; // CPU ocupada
-
+    while (cpu_first_free(cpus, num_cpus) >= 0) {
         if (rq->head == NULL) break; // Nada para executar
 
         // Seleciona o job mais curto
-        pcb_t *shortest_job = dequeue_shortest_job(rq);
+        pcb_t *shortest_job = dequeue_shortest_job(rq, cpus, num_cpus, predict);
         if (shortest_job == NULL) break;
 
-        // Coloca na CPU
-        shortest_job->status = TASK_RUNNING;
-        shortest_job->ellapsed_time_ms = 0;
-        cpus[i] = shortest_job;
+        // Coloca na CPU (de preferência a mesma onde correu antes)
+        int cpu = cpu_select(shortest_job, cpus, num_cpus);
+        cpu_dispatch(shortest_job, cpus, cpu, current_time_ms);
 
         DBG("SJF: Selected process %d with burst time %d ms on CPU %d at time %d ms\n",
-            shortest_job->pid, shortest_job->time_ms, i, current_time_ms);
+            shortest_job->pid, shortest_job->time_ms, cpu, current_time_ms);
     }
-}
\ No newline at end of file
+}
+
+void sjf_scheduler(uint32_t current_time_ms, queue_t *rq, pcb_t **cpus, int num_cpus) {
+    sjf_schedule(current_time_ms, rq, cpus, num_cpus, 0);
+}
+
+void sjf_exp_scheduler(uint32_t current_time_ms, queue_t *rq, pcb_t **cpus, int num_cpus) {
+    sjf_schedule(current_time_ms, rq, cpus, num_cpus, 1);
+}
@@ -17,4 +17,22 @@ void sjf_scheduler(uint32_t current_time_ms,
                    pcb_t **cpus,
                    int num_cpus);
 
+/**
+ * @brief SJF que não usa a duração declarada nos pedidos RUN
+ *
+ * A duração de cada burst é prevista por média exponencial dos bursts
+ * anteriores da mesma tarefa: tau(n+1) = alpha * t(n) + (1 - alpha) * tau(n),
+ * com alpha = sjf_alpha_pct / 100 e tau(0) = sjf_initial_guess_ms.
+ * A preempção compara a previsão menos o tempo já corrido no burst.
+ *
+ * @param current_time_ms Tempo atual da simulação em ms
+ * @param ready_queue     Fila de processos prontos
+ * @param cpus            Array de ponteiros para os processos em execução (um por CPU)
+ * @param num_cpus        Número de CPUs disponíveis
+ */
+void sjf_exp_scheduler(uint32_t current_time_ms,
+                       queue_t *ready_queue,
+                       pcb_t **cpus,
+                       int num_cpus);
+
 #endif // SJF_H
@@ -0,0 +1,81 @@
+#include "stats.h"
+
+#include <inttypes.h>
+
+#include "params.h"
+
+sim_stats_t sim_stats = {0};
+
+void stats_print(FILE *out, const char *scheduler_name, uint32_t current_time_ms) {
+    int num_cpus = topo_num_cpus();
+    uint64_t busy_ms = 0, total_ms = 0;
+    for (int i = 0; i < num_cpus; i++) {
+        busy_ms += STAT_GET(cpu_busy_ms[i]);
+        total_ms += STAT_GET(cpu_busy_ms[i]) + STAT_GET(cpu_idle_ms[i]);
+    }
+
+    fprintf(out, "Statistics for scheduler %s after %u ms\n", scheduler_name, current_time_ms);
+    fprintf(out, "  Dispatches:        %" PRIu64 "\n", STAT_GET(dispatches));
+    fprintf(out, "  Context switches:  %" PRIu64 "\n", STAT_GET(context_switches));
+    fprintf(out, "  Preemptions:       %" PRIu64 " (%" PRIu64 " on wake-up)\n",
+            STAT_GET(preemptions), STAT_GET(wakeup_preemptions));
+    fprintf(out, "  Migrations:        %" PRIu64 " (%" PRIu64 " across nodes)\n",
+            STAT_GET(migrations), STAT_GET(remote_migrations));
+    fprintf(out, "  Migration penalty: %" PRIu64 " ms\n", STAT_GET(migration_penalty_ms));
+    fprintf(out, "  Switch overhead:   %" PRIu64 " ms (%.2f%% of CPU time, %.2f%% of busy time)\n",
+            STAT_GET(switch_overhead_ms),
+            total_ms ? 100.0 * (double)STAT_GET(switch_overhead_ms) / (double)total_ms : 0.0,
+            busy_ms ? 100.0 * (double)STAT_GET(switch_overhead_ms) / (double)busy_ms : 0.0);
+    fprintf(out, "  Messages:          %" PRIu64 " received, %" PRIu64 " sent, %" PRIu64 " connections\n",
+            STAT_GET(messages_in), STAT_GET(messages_out), STAT_GET(connections));
+    fprintf(out, "  CPU utilization:   %.2f%%\n", total_ms ? 100.0 * (double)busy_ms / (double)total_ms : 0.0);
+    if (STAT_GET(bursts_done) > 0) {
+        uint64_t bursts = STAT_GET(bursts_done);
+        fprintf(out, "  Slowdown:          %" PRIu64 " bursts, mean %.2f, mean bounded %.2f (bound %u ms)\n",
+                bursts, (double)STAT_GET(slowdown_milli) / 1000.0 / (double)bursts,
+                (double)STAT_GET(bounded_slowdown_milli) / 1000.0 / (double)bursts, sim_params.slowdown_bound_ms);
+        fprintf(out, "  Response time:     mean %.1f ms\n", (double)STAT_GET(response_ms) / (double)bursts);
+    }
+    if (STAT_GET(rr_slices) > 0) {
+        fprintf(out, "  Time slices:       %" PRIu64 " computed, mean %.1f ms (latency %u ms, min granularity %u ms), "
+                "%" PRIu64 " renewed\n", STAT_GET(rr_slices),
+                (double)STAT_GET(rr_slice_ms) / (double)STAT_GET(rr_slices),
+                sim_params.rr_latency_ms, sim_params.rr_min_granularity_ms, STAT_GET(rr_slice_renewals));
+    }
+    if (STAT_GET(backfills) > 0) {
+        fprintf(out, "  Backfilled jobs:   %" PRIu64 "\n", STAT_GET(backfills));
+    }
+    if (STAT_GET(gang_dispatches) > 0 || STAT_GET(gang_blocked_ms) > 0) {
+        fprintf(out, "  Gangs:             %" PRIu64 " dispatched (%" PRIu64 " across nodes), "
+                "blocked by fragmentation %" PRIu64 " ms, held back by reservations %" PRIu64 " ms\n",
+                STAT_GET(gang_dispatches), STAT_GET(gang_split_dispatches), STAT_GET(gang_blocked_ms),
+                STAT_GET(gang_reserved_ms));
+        fprintf(out, "  Wasted CPU time:   %" PRIu64 " ms (%.2f%% of CPU time)\n", STAT_GET(wasted_cpu_ms),
+                total_ms ? 100.0 * (double)STAT_GET(wasted_cpu_ms) / (double)total_ms : 0.0);
+    }
+    if (topo_is_heterogeneous()) {
+        fprintf(out, "  Capacity moves:    %" PRIu64 " up-migrations, %" PRIu64 " down-migrations\n",
+                STAT_GET(up_migrations), STAT_GET(down_migrations));
+    }
+    if (STAT_GET(predicted_bursts) > 0) {
+        uint64_t bursts = STAT_GET(predicted_bursts);
+        fprintf(out, "  Burst prediction:  %" PRIu64 " bursts, mean absolute error %.1f ms (%.1f%% of the burst time)\n",
+                bursts, (double)STAT_GET(prediction_error_ms) / (double)bursts,
+                STAT_GET(predicted_burst_ms)
+                    ? 100.0 * (double)STAT_GET(prediction_error_ms) / (double)STAT_GET(predicted_burst_ms) : 0.0);
+    }
+    for (int i = 0; i < num_cpus; i++) {
+        fprintf(out, "  CPU %d (node %d, core %d, capacity %u%%): busy %" PRIu64 " ms, idle %" PRIu64 " ms\n",
+                i, topo_socket(i), topo_core(i), topo_capacity(i), STAT_GET(cpu_busy_ms[i]), STAT_GET(cpu_idle_ms[i]));
+    }
+}
+
+void stats_checkpoint(checkpoint_t *ck) {
+    // The structure is only made of stat_t, transfer them one by one
+    stat_t *stats = (stat_t *)&sim_stats;
+    for (size_t i = 0; i < sizeof(sim_stats) / sizeof(stat_t); i++) {
+        uint64_t value = atomic_load_explicit(&stats[i], memory_order_relaxed);
+        ckpt_bytes(ck, &value, sizeof(value));
+        if (ckpt_restoring(ck)) atomic_store_explicit(&stats[i], value, memory_order_relaxed);
+    }
+}
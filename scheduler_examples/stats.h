@@ -0,0 +1,87 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "checkpoint.h"
+#include "cpu.h"
+
+// Counters and gauges are atomic, because they are read by the metrics thread
+// while the scheduling and I/O threads update them
+typedef _Atomic uint64_t stat_t;
+
+// Counters collected during the simulation and reported when the simulator stops
+typedef struct {
+    stat_t dispatches;              // Number of times a task was placed on a CPU
+    stat_t context_switches;        // Dispatches on a CPU that last ran another task
+    stat_t preemptions;             // Number of times a running task was sent back to the ready queue
+    stat_t migrations;              // Dispatches on a different CPU than the previous one
+    stat_t remote_migrations;       // Migrations to a CPU on another node
+    stat_t migration_penalty_ms;    // Total burst time added because of migrations
+    stat_t switch_overhead_ms;      // CPU time spent in context switches
+    stat_t cpu_busy_ms[MAX_CPUS];   // Time each CPU had a task assigned (including switch overhead)
+    stat_t cpu_idle_ms[MAX_CPUS];   // Time each CPU was idle
+    stat_t connections;             // Connections accepted from applications
+    stat_t messages_in;             // Messages received from applications
+    stat_t messages_out;            // Messages sent to applications
+    stat_t gang_dispatches;         // Parallel tasks placed on their CPUs (GANG)
+    stat_t gang_split_dispatches;   // Parallel tasks placed on CPUs of more than one node
+    stat_t gang_blocked_ms;         // Time the first waiting parallel task did not fit in the idle CPUs
+    stat_t gang_reserved_ms;        // Time single-CPU tasks were held back by the reservation of a parallel task (GANG)
+    stat_t wasted_cpu_ms;           // Idle CPU time while tasks were waiting in the ready queue (GANG)
+    stat_t predicted_bursts;        // Bursts whose length was predicted (SJF-EXP)
+    stat_t prediction_error_ms;     // Sum of the absolute prediction errors
+    stat_t predicted_burst_ms;      // Sum of the actual length of the predicted bursts
+    stat_t up_migrations;           // Running tasks moved to a bigger core (heterogeneous CPUs)
+    stat_t down_migrations;         // Running tasks moved to a smaller core to make room for a long burst
+    stat_t energy_uj;               // Energy consumed by the CPUs, in microjoules
+    stat_t bursts_done;             // CPU bursts finished
+    stat_t slowdown_milli;          // Sum of the slowdowns of the bursts (response / burst), times 1000
+    stat_t bounded_slowdown_milli;  // Sum of the bounded slowdowns of the bursts, times 1000
+    stat_t backfills;               // Jobs started ahead of a waiting job (EASY)
+    stat_t response_ms;             // Sum of the response times of the bursts (RUN request to end of the burst)
+    stat_t rr_slices;               // Time slices computed at dispatch (RR-ADAPT)
+    stat_t rr_slice_ms;             // Sum of the computed time slices
+    stat_t rr_slice_renewals;       // Expired slices renewed because no task was waiting
+    stat_t wakeup_preemptions;      // Running tasks preempted by a ready task of a higher level (MLFQ)
+    stat_t hotplug_evictions;       // Tasks sent back to the ready queue because their CPU went offline
+    stat_t online_cpu_ms;           // Sum over the ticks of the online CPUs times the tick length
+    stat_t group_overflows;         // Tasks of a new group put in the default group because all the slots had tasks
+    stat_t groups_recycled;         // Groups without tasks whose slot was given to a new group
+    // Gauges, updated once per tick
+    stat_t sim_time_ms;             // Current simulation time
+    stat_t command_queue_len;       // Tasks waiting for a request from the application
+    stat_t ready_queue_len;         // Tasks waiting for a CPU
+    stat_t blocked_queue_len;       // Tasks being served by an I/O device
+    stat_t io_wait_queue_len;       // Tasks waiting for a free I/O device channel
+    stat_t busy_cpus;               // CPUs with a task assigned
+    stat_t online_cpus;             // CPUs online (see hotplug.h)
+    stat_t online_capacity_pct;     // Sum of the capacities of the online CPUs, in percent of a big core
+} sim_stats_t;
+
+extern sim_stats_t sim_stats;
+
+// Update a counter or gauge without ordering constraints (cheap on the hot path)
+#define STAT_ADD(counter, value) atomic_fetch_add_explicit(&sim_stats.counter, (uint64_t)(value), memory_order_relaxed)
+#define STAT_SET(gauge, value) atomic_store_explicit(&sim_stats.gauge, (uint64_t)(value), memory_order_relaxed)
+#define STAT_GET(counter) atomic_load_explicit(&sim_stats.counter, memory_order_relaxed)
+
+/**
+ * @brief Print the statistics of the simulation
+ *
+ * @param out             The stream where the statistics will be printed
+ * @param scheduler_name  Name of the scheduler used in the simulation
+ * @param current_time_ms Current simulation time in milliseconds
+ */
+void stats_print(FILE *out, const char *scheduler_name, uint32_t current_time_ms);
+
+/**
+ * @brief Save or restore the counters and gauges
+ *
+ * @param ck The checkpoint
+ */
+void stats_checkpoint(checkpoint_t *ck);
+
+#endif // STATS_H
@@ -0,0 +1,96 @@
+#include "tasktab.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+void task_table_init(task_table_t *t) {
+    *t = (task_table_t){0};
+}
+
+void task_table_free(task_table_t *t) {
+    free(t->pcbs);
+    free(t->remaining_ms);
+    free(t->expired);
+    task_table_init(t);
+}
+
+static int grow(task_table_t *t) {
+    int new_capacity = t->capacity ? t->capacity * 2 : 256;
+    pcb_t **pcbs = realloc(t->pcbs, (size_t)new_capacity * sizeof(pcb_t *));
+    if (pcbs) t->pcbs = pcbs;
+    uint32_t *remaining_ms = realloc(t->remaining_ms, (size_t)new_capacity * sizeof(uint32_t));
+    if (remaining_ms) t->remaining_ms = remaining_ms;
+    pcb_t **expired = realloc(t->expired, (size_t)new_capacity * sizeof(pcb_t *));
+    if (expired) t->expired = expired;
+    if (!pcbs || !remaining_ms || !expired) {
+        perror("realloc");
+        return -1;
+    }
+    t->capacity = new_capacity;
+    return 0;
+}
+
+int task_table_add(task_table_t *t, pcb_t *pcb, uint32_t remaining_ms) {
+    if (t->count == t->capacity && grow(t) != 0) return -1;
+    t->pcbs[t->count] = pcb;
+    t->remaining_ms[t->count] = remaining_ms;
+    t->count++;
+    return 0;
+}
+
+// Saturating countdown of all timers, returns how many reached zero.
+// Kept free of branches and pointers so it vectorizes.
+static int countdown(uint32_t *restrict remaining_ms, int count, uint32_t tick_ms) {
+    int expired = 0;
+    for (int i = 0; i < count; i++) {
+        uint32_t r = remaining_ms[i];
+        r = (r > tick_ms) ? r - tick_ms : 0;
+        remaining_ms[i] = r;
+        expired += (r == 0);
+    }
+    return expired;
+}
+
+int task_table_tick(task_table_t *t, uint32_t tick_ms) {
+    int num_expired = countdown(t->remaining_ms, t->count, tick_ms);
+    if (num_expired == 0) return 0;
+
+    // Stable compaction: keep the running timers in order, move out the expired tasks
+    int kept = 0, out = 0;
+    for (int i = 0; i < t->count; i++) {
+        if (t->remaining_ms[i] == 0) {
+            t->pcbs[i]->time_ms = 0;
+            t->expired[out++] = t->pcbs[i];
+        } else {
+            t->pcbs[kept] = t->pcbs[i];
+            t->remaining_ms[kept] = t->remaining_ms[i];
+            kept++;
+        }
+    }
+    t->count = kept;
+    return out;
+}
+
+int task_table_size(const task_table_t *t) {
+    return t->count;
+}
+
+void task_table_checkpoint(task_table_t *t, checkpoint_t *ck) {
+    uint32_t count = (uint32_t)t->count;
+    ckpt_u32(ck, &count);
+    for (uint32_t i = 0; i < count; i++) {
+        pcb_t *pcb = ckpt_restoring(ck) ? NULL : t->pcbs[i];
+        uint32_t remaining_ms = ckpt_restoring(ck) ? 0 : t->remaining_ms[i];
+        ckpt_pcb(ck, &pcb);
+        ckpt_u32(ck, &remaining_ms);
+        if (!ckpt_restoring(ck)) continue;
+        if (pcb == NULL) {
+            ckpt_fail(ck, "invalid blocked task");
+            return;
+        }
+        if (task_table_add(t, pcb, remaining_ms) != 0) {
+            ckpt_fail(ck, "out of memory");
+            return;
+        }
+    }
+}
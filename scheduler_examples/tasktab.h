@@ -0,0 +1,75 @@
+#ifndef TASKTAB_H
+#define TASKTAB_H
+
+#include <stdint.h>
+
+#include "checkpoint.h"
+#include "queue.h"
+
+/*
+ * Table of task timers in structure-of-arrays layout.
+ * The remaining time of each task is kept in a contiguous array, next to the
+ * array of its pcbs, instead of in the pcbs of a linked list. The per-tick
+ * countdown is then a single pass over that array that the compiler can
+ * vectorize, and the pcbs are only touched when their timer expires. This keeps
+ * the cost of a tick low with many tasks blocked at the same time.
+ *
+ * The entries are dense and stay in insertion order: expired entries are removed
+ * with a stable compaction, so tasks that expire in the same tick come out in the
+ * order they were added, as with a queue.
+ */
+
+typedef struct task_table_st {
+    pcb_t **pcbs;               // Task of each entry
+    uint32_t *remaining_ms;     // Time left on the timer of each entry
+    pcb_t **expired;            // Tasks removed by the last task_table_tick()
+    int count;                  // Number of entries
+    int capacity;               // Allocated entries in each array
+} task_table_t;
+
+/**
+ * @brief Initialize an empty table
+ */
+void task_table_init(task_table_t *t);
+
+/**
+ * @brief Release the arrays of a table (not the pcbs)
+ */
+void task_table_free(task_table_t *t);
+
+/**
+ * @brief Add a task with a timer
+ *
+ * The pcb is not updated while its timer runs, its time_ms is only set to 0
+ * when it expires.
+ *
+ * @param t            The table
+ * @param pcb          The task
+ * @param remaining_ms The time until the timer expires
+ * @return 0 on success, -1 on allocation failure
+ */
+int task_table_add(task_table_t *t, pcb_t *pcb, uint32_t remaining_ms);
+
+/**
+ * @brief Count down all timers by one tick and remove the expired entries
+ *
+ * @param t       The table
+ * @param tick_ms The length of the tick
+ * @return The number of expired tasks, available in t->expired in insertion order
+ */
+int task_table_tick(task_table_t *t, uint32_t tick_ms);
+
+/**
+ * @brief Number of tasks in the table
+ */
+int task_table_size(const task_table_t *t);
+
+/**
+ * @brief Save or restore the entries of a table (the table must be empty when restoring)
+ *
+ * @param t  The table
+ * @param ck The checkpoint
+ */
+void task_table_checkpoint(task_table_t *t, checkpoint_t *ck);
+
+#endif // TASKTAB_H
@@ -0,0 +1,7 @@
+#!/bin/bash
+# Short scenario for the hybrid emulation tests: parallel tasks next to serial
+# ones, so the CPUs of a gang run the emulation kernel in the same ticks.
+./app P1 1 2 &
+./app S1 1 &
+./app P2 1 3 &
+./app S2 1 &
@@ -0,0 +1,7 @@
+#!/bin/bash
+# Scenario for the I/O device tests: three applications read blocks scattered over the
+# disk, so several requests wait for its only channel, and a fourth one uses the network.
+./app-io iodev_reader1.csv &
+./app-io iodev_reader2.csv &
+./app-io iodev_reader3.csv &
+./app-io iodev_net.csv &
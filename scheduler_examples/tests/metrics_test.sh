@@ -0,0 +1,60 @@
+#!/bin/bash
+# Checks that a metrics client that disconnects before reading the reply does not
+# stop the simulator, and that the next scrape is still answered.
+# Usage: metrics_test.sh <build directory> <python3>
+set -u
+build_dir=$(cd "$1" && pwd)
+python=$2
+work_dir=$(mktemp -d)
+trap 'kill $scheduler_pid 2>/dev/null; rm -rf "$work_dir"' EXIT
+cd "$work_dir" || exit 1
+
+"$build_dir/scheduler" FIFO > scheduler.log 2>&1 &
+scheduler_pid=$!
+for _ in $(seq 50); do
+    [ -S /tmp/scheduler-stats.sock ] && break
+    sleep 0.1
+done
+
+# Half of the clients send an HTTP request first, the others close right away
+"$python" - <<'PYTHON'
+import socket
+for i in range(20):
+    s = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    s.connect("/tmp/scheduler-stats.sock")
+    if i % 2 == 0:
+        s.sendall(b"GET / HTTP/1.0\r\n\r\n")
+    s.close()
+PYTHON
+sleep 0.2
+
+status=0
+if ! kill -0 $scheduler_pid 2>/dev/null; then
+    wait $scheduler_pid
+    echo "The simulator stopped (exit status $?) after a client disconnected early"
+    exit 1
+fi
+scrape=$("$python" - <<'PYTHON'
+import socket
+s = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+s.connect("/tmp/scheduler-stats.sock")
+s.sendall(b"GET / HTTP/1.0\r\n\r\n")
+data = b""
+while True:
+    chunk = s.recv(65536)
+    if not chunk:
+        break
+    data += chunk
+print(data.decode())
+PYTHON
+)
+if ! grep -q "^ossim_sim_time_ms " <<< "$scrape"; then
+    echo "The scrape after the early disconnections was not answered"
+    status=1
+fi
+kill -INT $scheduler_pid
+wait $scheduler_pid || status=1
+if [ $status -ne 0 ]; then
+    cat scheduler.log
+fi
+exit $status
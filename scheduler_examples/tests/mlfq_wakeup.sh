@@ -0,0 +1,14 @@
+#!/bin/bash
+# Scenario for the MLFQ wake-up preemption and I/O boost tests, on two CPUs: two
+# long tasks keep both CPUs busy at different levels, an interactive task wakes
+# up from each I/O request while they run, and short tasks arrive at level 0.
+./app L1 6 &
+sleep 1
+./app-io interactive.csv &
+./app L2 4 &
+sleep 1
+./app S1 1 &
+./app S2 1 &
+sleep 1
+./app S3 1 &
+./app S4 1 &
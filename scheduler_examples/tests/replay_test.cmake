@@ -0,0 +1,55 @@
+# Replays a scenario with a scheduler and compares the report with its golden file.
+# Variables: SCHEDULER (executable), SCENARIO, POLICY, GOLDEN, OUTPUT, UPDATE_GOLDEN
+# ARGS holds more options of the scheduler, e.g. "-p emulate=1".
+# With RESPONSE_BASELINE, the mean response time must also be lower than in that
+# report, so a change cannot lose the improvement by updating the golden file.
+# With CHECKPOINT_MS, the state is saved at that time by a first replay, and the
+# report comes from a second replay restored from that checkpoint.
+separate_arguments(extra_args UNIX_COMMAND "${ARGS}")
+set(restore_args)
+if(CHECKPOINT_MS)
+    set(checkpoint ${OUTPUT}.ckpt)
+    execute_process(
+            COMMAND ${SCHEDULER} ${extra_args} -r ${SCENARIO} -o ${OUTPUT} -s ${CHECKPOINT_MS}:${checkpoint} ${POLICY}
+            OUTPUT_QUIET
+            RESULT_VARIABLE result)
+    if(NOT result EQUAL 0 OR NOT EXISTS ${checkpoint})
+        message(FATAL_ERROR "Checkpoint of ${SCENARIO} with ${POLICY} at ${CHECKPOINT_MS} ms failed (${result})")
+    endif()
+    file(REMOVE ${OUTPUT})
+    set(restore_args -l ${checkpoint})
+endif()
+
+execute_process(
+        COMMAND ${SCHEDULER} ${extra_args} -r ${SCENARIO} -o ${OUTPUT} ${restore_args} ${POLICY}
+        OUTPUT_QUIET
+        RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "Replay of ${SCENARIO} with ${POLICY} failed (${result})")
+endif()
+
+file(READ ${OUTPUT} actual)
+if(RESPONSE_BASELINE)
+    file(READ ${RESPONSE_BASELINE} baseline)
+    string(REGEX MATCH "Response mean: ([0-9.]+)" match "${actual}")
+    set(response ${CMAKE_MATCH_1})
+    string(REGEX MATCH "Response mean: ([0-9.]+)" match "${baseline}")
+    set(baseline_response ${CMAKE_MATCH_1})
+    if(NOT response LESS baseline_response)
+        message(FATAL_ERROR "Mean response time ${response} ms is not lower than ${baseline_response} ms "
+                "in ${RESPONSE_BASELINE}")
+    endif()
+endif()
+
+if(UPDATE_GOLDEN)
+    configure_file(${OUTPUT} ${GOLDEN} COPYONLY)
+    message(STATUS "Updated ${GOLDEN}")
+    return()
+endif()
+
+file(READ ${GOLDEN} expected)
+if(NOT actual STREQUAL expected)
+    message(FATAL_ERROR "Results differ from ${GOLDEN}\n"
+            "Expected:\n${expected}\nActual:\n${actual}\n"
+            "If the change is intended, rerun with -DUPDATE_GOLDEN=ON to update the golden files.")
+endif()
@@ -0,0 +1,58 @@
+#!/bin/bash
+# Runs the sharded simulator with real applications and checks that a task moved
+# between shards finishes with times on the clock of the shard that acknowledged it.
+# Usage: router_test.sh <build directory>
+# Two shards of one CPU with FIFO; the connections alternate between the shards, so
+# the shard with S1 and S2 becomes idle while L2 still waits behind L1 in the other
+# one, and the router moves L2.
+set -u
+build_dir=$(cd "$1" && pwd)
+work_dir=$(mktemp -d)
+trap 'kill $router_pid 2>/dev/null; rm -rf "$work_dir"' EXIT
+cd "$work_dir" || exit 1
+
+"$build_dir/router" -n 2 -t 1:1:1 -b 50 -- FIFO > router.log 2>&1 &
+router_pid=$!
+for _ in $(seq 50); do
+    [ -S /tmp/scheduler.sock ] && break
+    sleep 0.1
+done
+sleep 0.3
+
+app_pids=()
+for app in "S1 1" "L1 3" "S2 1" "L2 3"; do
+    "$build_dir/app" $app > "app-${app% *}.log" 2>&1 &
+    app_pids+=($!)
+    sleep 0.05
+done
+status=0
+for pid in "${app_pids[@]}"; do
+    wait "$pid" || status=1
+done
+kill -INT $router_pid
+wait $router_pid
+
+if ! grep -q "1 tasks moved in" router.log; then
+    echo "No task was moved between the shards"
+    status=1
+fi
+for name in S1 L1 S2 L2; do
+    line=$(grep "finished at time" "app-$name.log")
+    if [ -z "$line" ]; then
+        echo "$name did not finish"
+        status=1
+        continue
+    fi
+    # The ACK (finish - elapsed) must come before the DONE, and the elapsed time covers the CPU time
+    finish_ms=$(sed -E 's/.*finished at time ([0-9]+) ms.*/\1/' <<< "$line")
+    elapsed_ms=$(sed -E 's/.*Elapsed: ([0-9]+)\.([0-9]+) seconds.*/\1\2/' <<< "$line")
+    cpu_ms=$(sed -E 's/.*CPU: ([0-9]+)\.([0-9]+) seconds.*/\1\2/' <<< "$line")
+    if [ $((10#$elapsed_ms)) -lt $((10#$cpu_ms)) ] || [ $((10#$elapsed_ms)) -gt $((10#$finish_ms)) ]; then
+        echo "Inconsistent times: $line"
+        status=1
+    fi
+done
+if [ $status -ne 0 ]; then
+    cat router.log app-*.log
+fi
+exit $status
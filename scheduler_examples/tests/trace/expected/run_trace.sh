@@ -0,0 +1,7 @@
+#!/bin/bash
+# 2 tasks imported from a scheduler trace of 0.400 s, started at the time they
+# appeared in the trace. Replay with: ./scheduler -r out/run_trace.sh <scheduler>
+./app-io out/work-42.csv &
+sleep 0.170
+./app-io out/my_hog-43.csv &
+wait
@@ -0,0 +1,34 @@
+#!/bin/bash
+# Imports the same small trace in the format of ftrace and of perf sched script,
+# checks the burst files and run_trace.sh against tests/trace/expected, and that
+# the scenario replays. A trace whose events are not understood must fail.
+# Usage: trace_import_test.sh <build directory>
+set -u
+build_dir=$(cd "$1" && pwd)
+trace_dir=$(cd "$(dirname "$0")/trace" && pwd)
+work_dir=$(mktemp -d)
+trap 'rm -rf "$work_dir"' EXIT
+cd "$work_dir" || exit 1
+
+status=0
+for format in ftrace perf; do
+    if ! "$build_dir/trace-import" -o out "$trace_dir/$format.txt"; then
+        echo "Import of the $format trace failed"
+        status=1
+    elif ! diff -r "$trace_dir/expected" out; then
+        echo "The import of the $format trace differs from $trace_dir/expected"
+        status=1
+    elif ! "$build_dir/scheduler" -r out/run_trace.sh -o report.txt FIFO > /dev/null 2>&1 ||
+         grep -q unfinished report.txt; then
+        echo "The scenario imported from the $format trace did not replay"
+        status=1
+    fi
+    rm -rf out report.txt
+done
+
+printf '    work 42 [000]  1000.000000: sched:sched_switch: work/42 S -> idle\n' > unknown.txt
+if "$build_dir/trace-import" -o out unknown.txt 2> /dev/null; then
+    echo "A trace without any event understood was imported"
+    status=1
+fi
+exit $status
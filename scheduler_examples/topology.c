@@ -0,0 +1,119 @@
+#include "topology.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static int sockets = 2;
+static int cores_per_socket = 2;
+static int threads_per_core = 1;
+
+// Capacity of each core, the last value repeats for the remaining cores
+static uint32_t capacities[MAX_CPUS] = {100};
+static int num_capacities = 1;
+
+int topo_configure(const char *spec) {
+    int s, c, t;
+    char extra;
+    if (sscanf(spec, "%d:%d:%d%c", &s, &c, &t, &extra) != 3 || s <= 0 || c <= 0 || t <= 0) {
+        fprintf(stderr, "Invalid topology %s, expected sockets:cores:threads\n", spec);
+        return -1;
+    }
+    // Bound each factor first, so the product cannot overflow
+    if (s > MAX_CPUS || c > MAX_CPUS || t > MAX_CPUS || s * c * t > MAX_CPUS) {
+        fprintf(stderr, "Topology %s has more than %d CPUs\n", spec, MAX_CPUS);
+        return -1;
+    }
+    sockets = s;
+    cores_per_socket = c;
+    threads_per_core = t;
+    return 0;
+}
+
+int topo_set_capacities(const char *spec) {
+    uint32_t values[MAX_CPUS];
+    int n = 0;
+    const char *p = spec;
+    while (1) {
+        char *endptr;
+        errno = 0;
+        long value = strtol(p, &endptr, 10);
+        if (errno != 0 || endptr == p || value < 1 || value > 100 || n == MAX_CPUS ||
+            (*endptr != '\0' && *endptr != ',')) {
+            fprintf(stderr, "Invalid capacities %s, expected a list of percentages (1-100) per core\n", spec);
+            return -1;
+        }
+        values[n++] = (uint32_t)value;
+        if (*endptr == '\0') break;
+        p = endptr + 1;
+    }
+    for (int i = 0; i < n; i++) capacities[i] = values[i];
+    num_capacities = n;
+    return 0;
+}
+
+int topo_num_cpus(void) {
+    return sockets * cores_per_socket * threads_per_core;
+}
+
+int topo_num_sockets(void) {
+    return sockets;
+}
+
+int topo_socket(int cpu) {
+    return cpu / (cores_per_socket * threads_per_core);
+}
+
+int topo_core(int cpu) {
+    return cpu / threads_per_core;
+}
+
+uint32_t topo_capacity(int cpu) {
+    int core = topo_core(cpu);
+    return capacities[core < num_capacities ? core : num_capacities - 1];
+}
+
+uint32_t topo_max_capacity(void) {
+    uint32_t max = 0;
+    for (int i = 0; i < topo_num_cpus(); i++) {
+        if (topo_capacity(i) > max) max = topo_capacity(i);
+    }
+    return max;
+}
+
+uint32_t topo_min_capacity(void) {
+    uint32_t min = 100;
+    for (int i = 0; i < topo_num_cpus(); i++) {
+        if (topo_capacity(i) < min) min = topo_capacity(i);
+    }
+    return min;
+}
+
+int topo_is_heterogeneous(void) {
+    return topo_min_capacity() != topo_max_capacity();
+}
+
+topo_distance_en topo_distance(int a, int b) {
+    if (a == b) return TOPO_SAME_CPU;
+    if (topo_core(a) == topo_core(b)) return TOPO_SMT;
+    if (topo_socket(a) == topo_socket(b)) return TOPO_SAME_NODE;
+    return TOPO_REMOTE;
+}
+
+int topo_busy_siblings(pcb_t **cpus, int cpu) {
+    int first = topo_core(cpu) * threads_per_core;
+    int busy = 0;
+    for (int i = first; i < first + threads_per_core; i++) {
+        if (i != cpu && cpus[i] != NULL) busy++;
+    }
+    return busy;
+}
+
+int topo_socket_load(pcb_t **cpus, int socket) {
+    int per_socket = cores_per_socket * threads_per_core;
+    int busy = 0;
+    for (int i = socket * per_socket; i < (socket + 1) * per_socket; i++) {
+        if (cpus[i] != NULL) busy++;
+    }
+    return busy;
+}
@@ -0,0 +1,102 @@
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+#include "queue.h"
+
+#define MAX_CPUS 256
+
+// Distance between two CPUs, from the closest to the farthest
+typedef enum {
+    TOPO_SAME_CPU = 0,  // The same hardware thread
+    TOPO_SMT,           // SMT siblings, sharing the same core and its caches
+    TOPO_SAME_NODE,     // Different cores in the same socket (NUMA node)
+    TOPO_REMOTE,        // Different sockets
+} topo_distance_en;
+
+/**
+ * @brief Configure the topology from a "sockets:cores:threads" description
+ *
+ * The CPUs are numbered socket by socket, core by core, so the SMT siblings
+ * of a core have consecutive numbers. The default topology is 2:2:1.
+ *
+ * @param spec Number of sockets, cores per socket and hardware threads per core
+ * @return 0 on success, -1 if the description is invalid or has more than MAX_CPUS CPUs
+ */
+int topo_configure(const char *spec);
+
+/**
+ * @brief Set the capacity (speed) of the cores, for heterogeneous (big.LITTLE) systems
+ *
+ * The capacities are a comma separated list of percentages of the speed of the
+ * fastest core (1-100), one per core in the order of topo_core(). Cores after the
+ * end of the list use the last value, so "100,50" makes core 0 big and the others
+ * little. SMT siblings share the capacity of their core. By default, all cores
+ * have a capacity of 100.
+ *
+ * @param spec The list of capacities
+ * @return 0 on success, -1 if the list is invalid
+ */
+int topo_set_capacities(const char *spec);
+
+/**
+ * @brief Total number of CPUs (hardware threads) in the topology
+ */
+int topo_num_cpus(void);
+
+/**
+ * @brief Number of sockets (NUMA nodes) in the topology
+ */
+int topo_num_sockets(void);
+
+/**
+ * @brief Socket (NUMA node) of a CPU
+ */
+int topo_socket(int cpu);
+
+/**
+ * @brief Core of a CPU, numbered across all sockets
+ */
+int topo_core(int cpu);
+
+/**
+ * @brief Capacity of a CPU, in percent of the speed of the fastest core
+ */
+uint32_t topo_capacity(int cpu);
+
+/**
+ * @brief Highest capacity of the CPUs in the topology
+ */
+uint32_t topo_max_capacity(void);
+
+/**
+ * @brief Lowest capacity of the CPUs in the topology
+ */
+uint32_t topo_min_capacity(void);
+
+/**
+ * @brief Check if the CPUs have different capacities
+ */
+int topo_is_heterogeneous(void);
+
+/**
+ * @brief Distance between two CPUs
+ */
+topo_distance_en topo_distance(int a, int b);
+
+/**
+ * @brief Number of busy CPUs that share the core of a CPU (excluding the CPU itself)
+ *
+ * @param cpus Array with the task running on each CPU (NULL if idle)
+ * @param cpu  The index of the CPU
+ */
+int topo_busy_siblings(pcb_t **cpus, int cpu);
+
+/**
+ * @brief Number of busy CPUs in a socket
+ *
+ * @param cpus   Array with the task running on each CPU (NULL if idle)
+ * @param socket The socket
+ */
+int topo_socket_load(pcb_t **cpus, int socket);
+
+#endif // TOPOLOGY_H
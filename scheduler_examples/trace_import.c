@@ -0,0 +1,580 @@
+#include <ctype.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+ * Trace importer: reads the text of a Linux scheduler trace (the trace file of
+ * ftrace with the sched_switch and sched_wakeup events, or the output of
+ * `perf sched script`) and rebuilds, for each task, its sequence of CPU bursts
+ * and sleeps. Each task becomes a burst file in the format of app-io
+ * (cpu,io,nice in ms), and a scenario script starts one app-io per task at the
+ * time the task appeared in the trace, so the captured load can be run live or
+ * replayed with `./scheduler -r` through every scheduler.
+ *
+ * The trace is read one line at a time and the bursts of each task are written
+ * to its file in small batches, so the memory used depends on the number of
+ * tasks (at most -n) and not on the length of the trace.
+ *
+ * Run like: ./trace-import -o prod /sys/kernel/tracing/trace
+ *           perf sched script | ./trace-import -o prod -
+ */
+
+#define MAX_LINE_LEN 4096
+#define COMM_LEN 16
+#define BURST_BATCH 64              // Bursts kept per task before they are written to its file
+#define DEFAULT_MAX_TASKS 1024
+#define DEFAULT_MIN_SLEEP_MS 10     // One tick of the simulator
+#define DEFAULT_MIN_CPU_MS 10
+#define NS_PER_MS 1000000ull
+#define SCRIPT_NAME "run_trace.sh"
+
+typedef enum {
+    TASK_NEW = 0,       // Not seen running or waking yet
+    TASK_RUNNING,       // On a CPU since run_start_ns
+    TASK_RUNNABLE,      // Woken or preempted, waiting for a CPU
+    TASK_SLEEPING,      // Blocked since sleep_start_ns
+    TASK_EXITED,
+} task_state_en;
+
+typedef struct {
+    uint32_t cpu_ms;
+    uint32_t io_ms;
+    int nice;
+} trace_burst_t;
+
+typedef struct {
+    int32_t pid;                    // 0 = free slot
+    char comm[COMM_LEN];
+    task_state_en state;
+    int nice;
+    uint64_t arrival_ns;
+    uint64_t run_start_ns;
+    uint64_t sleep_start_ns;
+    uint64_t cpu_ns;                // CPU time of the current burst
+    uint64_t total_cpu_ns;
+    uint32_t num_bursts;            // Bursts written or in the batch
+    int file_created;
+    int num_batch;
+    trace_burst_t batch[BURST_BATCH];
+} trace_task_t;
+
+static trace_task_t *tasks = NULL;
+static size_t tasks_capacity = 0;
+static size_t num_tasks = 0;
+static size_t max_tasks = DEFAULT_MAX_TASKS;
+static uint64_t min_sleep_ns = DEFAULT_MIN_SLEEP_MS * NS_PER_MS;
+static uint64_t min_cpu_ns = DEFAULT_MIN_CPU_MS * NS_PER_MS;
+static const char *out_dir = NULL;
+static uint64_t first_ns = 0;
+static uint64_t last_ns = 0;
+static int have_time = 0;
+static uint64_t num_events = 0;             // Scheduler events applied
+static uint64_t num_unparsed = 0;           // Scheduler events in a format that is not understood
+static uint64_t ignored_tasks = 0;
+static int write_failed = 0;
+
+// The file of a task: <comm>-<pid>.csv, with the characters that app-io would not keep in the name replaced
+static void task_file_name(const trace_task_t *t, char *out, size_t size) {
+    char comm[COMM_LEN];
+    size_t i;
+    for (i = 0; t->comm[i] != '\0' && i < COMM_LEN - 1; i++) {
+        comm[i] = (isalnum((unsigned char)t->comm[i]) || t->comm[i] == '_') ? t->comm[i] : '_';
+    }
+    comm[i] = '\0';
+    snprintf(out, size, "%s-%d.csv", i ? comm : "task", t->pid);
+}
+
+static void task_path(const trace_task_t *t, char *out, size_t size) {
+    char name[COMM_LEN + 32];
+    task_file_name(t, name, sizeof(name));
+    snprintf(out, size, "%s/%s", out_dir, name);
+}
+
+static void flush_task(trace_task_t *t) {
+    if (t->num_batch == 0) return;
+    char path[PATH_MAX];
+    task_path(t, path, sizeof(path));
+    FILE *f = fopen(path, t->file_created ? "a" : "w");
+    if (f == NULL) {
+        if (!write_failed) perror(path);
+        write_failed = 1;
+        t->num_batch = 0;
+        return;
+    }
+    if (!t->file_created) {
+        fprintf(f, "#cpu(ms),io(ms),nice %s (pid %d), imported from a scheduler trace\n", t->comm, t->pid);
+        t->file_created = 1;
+    }
+    for (int i = 0; i < t->num_batch; i++) {
+        fprintf(f, "%" PRIu32 ",%" PRIu32 ",%d\n", t->batch[i].cpu_ms, t->batch[i].io_ms, t->batch[i].nice);
+    }
+    if (fclose(f) != 0 && !write_failed) {
+        perror(path);
+        write_failed = 1;
+    }
+    t->num_batch = 0;
+}
+
+// End the current burst of a task, followed by io_ns of sleep
+static void emit_burst(trace_task_t *t, uint64_t io_ns) {
+    uint64_t cpu_ms = (t->cpu_ns + NS_PER_MS / 2) / NS_PER_MS;
+    if (cpu_ms == 0) cpu_ms = 1;    // A task that ran at all ran for at least 1 ms
+    if (cpu_ms > UINT32_MAX) cpu_ms = UINT32_MAX;
+    uint64_t io_ms = (io_ns + NS_PER_MS / 2) / NS_PER_MS;
+    if (io_ms > UINT32_MAX) io_ms = UINT32_MAX;
+
+    t->batch[t->num_batch++] = (trace_burst_t){
+        .cpu_ms = (uint32_t)cpu_ms,
+        .io_ms = (uint32_t)io_ms,
+        .nice = t->nice,
+    };
+    t->num_bursts++;
+    t->total_cpu_ns += t->cpu_ns;
+    t->cpu_ns = 0;
+    if (t->num_batch == BURST_BATCH) flush_task(t);
+}
+
+static int tasks_grow(void) {
+    size_t capacity = tasks_capacity ? tasks_capacity * 2 : 256;
+    trace_task_t *table = calloc(capacity, sizeof(trace_task_t));
+    if (table == NULL) return -1;
+    for (size_t i = 0; i < tasks_capacity; i++) {
+        if (tasks[i].pid == 0) continue;
+        size_t h = (uint32_t)tasks[i].pid % capacity;
+        while (table[h].pid != 0) h = (h + 1) % capacity;
+        table[h] = tasks[i];
+    }
+    free(tasks);
+    tasks = table;
+    tasks_capacity = capacity;
+    return 0;
+}
+
+// Find or create a task; NULL for the idle task, and for new tasks when there are already max_tasks
+static trace_task_t *find_task(int32_t pid, const char *comm) {
+    if (pid <= 0) return NULL;
+    if (tasks_capacity > 0) {
+        size_t h = (uint32_t)pid % tasks_capacity;
+        while (tasks[h].pid != 0) {
+            if (tasks[h].pid == pid) {
+                if (comm != NULL && tasks[h].state == TASK_NEW) {
+                    snprintf(tasks[h].comm, COMM_LEN, "%s", comm);
+                }
+                return &tasks[h];
+            }
+            h = (h + 1) % tasks_capacity;
+        }
+    }
+    if (num_tasks >= max_tasks) {
+        ignored_tasks++;
+        return NULL;
+    }
+    if (2 * (num_tasks + 1) > tasks_capacity && tasks_grow() != 0) {
+        perror("calloc");
+        exit(EXIT_FAILURE);
+    }
+    size_t h = (uint32_t)pid % tasks_capacity;
+    while (tasks[h].pid != 0) h = (h + 1) % tasks_capacity;
+    trace_task_t *t = &tasks[h];
+    t->pid = pid;
+    snprintf(t->comm, COMM_LEN, "%s", comm ? comm : "");
+    t->state = TASK_NEW;
+    num_tasks++;
+    return t;
+}
+
+// Nice value from the kernel priority of a normal task (100..139); real-time tasks get -20
+static int prio_to_nice(long prio) {
+    if (prio < 100) return -20;
+    if (prio > 139) return 19;
+    return (int)(prio - 120);
+}
+
+// The task is woken at now_ns: a long enough sleep ends the burst
+static void task_wakeup(trace_task_t *t, uint64_t now_ns) {
+    switch (t->state) {
+        case TASK_NEW:
+            t->arrival_ns = now_ns;
+            t->state = TASK_RUNNABLE;
+            break;
+        case TASK_SLEEPING: {
+            uint64_t sleep_ns = now_ns - t->sleep_start_ns;
+            // Shorter sleeps are dropped, and the bursts around them are merged
+            if (sleep_ns >= min_sleep_ns && t->cpu_ns > 0) emit_burst(t, sleep_ns);
+            t->state = TASK_RUNNABLE;
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+static void task_switch_in(trace_task_t *t, uint64_t now_ns) {
+    if (t->state == TASK_EXITED) return;
+    task_wakeup(t, now_ns);     // In case the wakeup is not in the trace
+    t->state = TASK_RUNNING;
+    t->run_start_ns = now_ns;
+}
+
+static void task_switch_out(trace_task_t *t, uint64_t now_ns, const char *prev_state) {
+    if (t->state == TASK_EXITED) return;
+    if (t->state == TASK_NEW) {
+        // Running since before the start of the trace
+        t->arrival_ns = first_ns;
+        t->run_start_ns = first_ns;
+    }
+    if (t->state == TASK_RUNNING || t->state == TASK_NEW) {
+        t->cpu_ns += now_ns - t->run_start_ns;
+    }
+    // R or R+ = preempted, still runnable: the burst goes on
+    if (prev_state[0] == 'R') {
+        t->state = TASK_RUNNABLE;
+    } else if (prev_state[0] == 'X' || prev_state[0] == 'Z' || prev_state[0] == 'x') {
+        if (t->cpu_ns > 0) emit_burst(t, 0);
+        t->state = TASK_EXITED;
+    } else {
+        t->state = TASK_SLEEPING;
+        t->sleep_start_ns = now_ns;
+    }
+}
+
+// Value of "key=" in an event, up to the next space or, for comm keys, up to " <next_key>="
+static int get_field(const char *fields, const char *key, const char *next_key, char *out, size_t size) {
+    char pattern[32];
+    snprintf(pattern, sizeof(pattern), "%s=", key);
+    const char *start = fields;
+    while ((start = strstr(start, pattern)) != NULL) {
+        if (start == fields || start[-1] == ' ') break;
+        start++;
+    }
+    if (start == NULL) return -1;
+    start += strlen(pattern);
+    const char *end;
+    if (next_key != NULL) {
+        snprintf(pattern, sizeof(pattern), " %s=", next_key);
+        end = strstr(start, pattern);
+        if (end == NULL) return -1;
+    } else {
+        end = start;
+        while (*end != '\0' && !isspace((unsigned char)*end)) end++;
+    }
+    size_t len = (size_t)(end - start);
+    if (len >= size) len = size - 1;
+    memcpy(out, start, len);
+    out[len] = '\0';
+    return 0;
+}
+
+static long get_long(const char *fields, const char *key, long def) {
+    char value[32];
+    if (get_field(fields, key, NULL, value, sizeof(value)) != 0) return def;
+    return strtol(value, NULL, 10);
+}
+
+// "<secs>.<fraction>:" just before the event name
+static int parse_timestamp(const char *line, const char *event, uint64_t *ns) {
+    const char *p = event;
+    while (p > line && isspace((unsigned char)p[-1])) p--;
+    if (p == line || p[-1] != ':') return -1;
+    const char *end = p - 1;
+    const char *start = end;
+    while (start > line && (isdigit((unsigned char)start[-1]) || start[-1] == '.')) start--;
+    if (start == end) return -1;
+
+    uint64_t secs = 0, frac = 0;
+    int frac_digits = 0, in_frac = 0;
+    for (const char *c = start; c < end; c++) {
+        if (*c == '.') {
+            in_frac = 1;
+        } else if (!in_frac) {
+            secs = secs * 10 + (uint64_t)(*c - '0');
+        } else if (frac_digits < 9) {
+            frac = frac * 10 + (uint64_t)(*c - '0');
+            frac_digits++;
+        }
+    }
+    while (frac_digits++ < 9) frac *= 10;
+    *ns = secs * 1000000000ull + frac;
+    return 0;
+}
+
+// A task in the format perf prints (libtraceevent): "<comm>:<pid> [<prio>]", where the comm
+// can have spaces and colons. Returns the text after the priority, or NULL.
+static const char *parse_perf_task(const char *s, char *comm, size_t size, int32_t *pid, long *prio) {
+    while (*s == ' ') s++;
+    const char *open = strstr(s, " [");
+    if (open == NULL) return NULL;
+    const char *colon = open;
+    while (colon > s && colon[-1] != ':') colon--;
+    if (colon == s) return NULL;
+    char *end;
+    long value = strtol(colon, &end, 10);
+    if (end == colon || end != open) return NULL;
+    *pid = (int32_t)value;
+    size_t len = (size_t)(colon - 1 - s);
+    if (len >= size) len = size - 1;
+    memcpy(comm, s, len);
+    comm[len] = '\0';
+    *prio = strtol(open + 2, &end, 10);
+    if (*end != ']') return NULL;
+    return end + 1;
+}
+
+// A sched_switch in the format of the tracepoint ("prev_comm=... ==> next_comm=...") or of perf
+static int parse_switch(const char *fields, char *prev_comm, int32_t *prev_pid, long *prev_prio,
+                        char *prev_state, size_t state_size, char *next_comm, int32_t *next_pid, long *next_prio) {
+    const char *next_fields = strstr(fields, "==>");
+    if (next_fields == NULL) return -1;
+    if (strstr(fields, "prev_comm=") != NULL) {
+        if (get_field(fields, "prev_comm", "prev_pid", prev_comm, COMM_LEN) != 0 ||
+            get_field(fields, "prev_state", NULL, prev_state, state_size) != 0 ||
+            get_field(next_fields + 4, "next_comm", "next_pid", next_comm, COMM_LEN) != 0) {
+            return -1;
+        }
+        *prev_pid = (int32_t)get_long(fields, "prev_pid", -1);
+        *prev_prio = get_long(fields, "prev_prio", 120);
+        *next_pid = (int32_t)get_long(next_fields, "next_pid", -1);
+        *next_prio = get_long(next_fields, "next_prio", 120);
+        return (*prev_pid >= 0 && *next_pid >= 0) ? 0 : -1;
+    }
+    // perf: "<comm>:<pid> [<prio>] <state> ==> <comm>:<pid> [<prio>]"
+    const char *rest = parse_perf_task(fields, prev_comm, COMM_LEN, prev_pid, prev_prio);
+    if (rest == NULL || rest >= next_fields) return -1;
+    while (*rest == ' ') rest++;
+    size_t len = 0;
+    while (rest + len < next_fields && rest[len] != ' ') len++;
+    if (len == 0 || len >= state_size) return -1;
+    memcpy(prev_state, rest, len);
+    prev_state[len] = '\0';
+    return parse_perf_task(next_fields + 3, next_comm, COMM_LEN, next_pid, next_prio) ? 0 : -1;
+}
+
+// Parse one line of the trace: 1 for an event that was applied, 0 for a line without a
+// scheduler event, -1 for a scheduler event that could not be understood
+static int parse_line(const char *line) {
+    const char *event;
+    int type;   // 0 = switch, 1 = wakeup, 2 = exit
+    if ((event = strstr(line, "sched_switch:")) != NULL) {
+        type = 0;
+    } else if ((event = strstr(line, "sched_wakeup:")) != NULL ||
+               (event = strstr(line, "sched_wakeup_new:")) != NULL) {
+        type = 1;
+    } else if ((event = strstr(line, "sched_process_exit:")) != NULL) {
+        type = 2;
+    } else {
+        return 0;
+    }
+    // perf prints the event with its subsystem ("sched:sched_switch:")
+    const char *name = event;
+    if (name - line >= 6 && strncmp(name - 6, "sched:", 6) == 0) name -= 6;
+    uint64_t now_ns;
+    if (parse_timestamp(line, name, &now_ns) != 0) return -1;
+    const char *fields = strchr(event, ':') + 1;
+    while (*fields == ' ') fields++;
+
+    char comm[COMM_LEN], next_comm[COMM_LEN], prev_state[8];
+    int32_t pid = -1, next_pid = -1;
+    long prio = 120, next_prio = 120;
+    if (type == 0) {
+        if (parse_switch(fields, comm, &pid, &prio, prev_state, sizeof(prev_state),
+                         next_comm, &next_pid, &next_prio) != 0) {
+            return -1;
+        }
+    } else if (get_field(fields, "comm", "pid", comm, sizeof(comm)) == 0) {
+        pid = (int32_t)get_long(fields, "pid", -1);
+        prio = get_long(fields, "prio", 120);
+    } else if (parse_perf_task(fields, comm, sizeof(comm), &pid, &prio) == NULL) {
+        return -1;
+    }
+    if (pid < 0) return -1;
+
+    if (!have_time) {
+        first_ns = now_ns;
+        have_time = 1;
+    }
+    if (now_ns < last_ns) now_ns = last_ns;     // The CPUs of a trace can be slightly out of order
+    last_ns = now_ns;
+
+    trace_task_t *t = find_task(pid, comm);
+    if (type == 0) {
+        if (t != NULL) {
+            t->nice = prio_to_nice(prio);
+            task_switch_out(t, now_ns, prev_state);
+        }
+        trace_task_t *next = find_task(next_pid, next_comm);
+        if (next != NULL) {
+            next->nice = prio_to_nice(next_prio);
+            task_switch_in(next, now_ns);
+        }
+    } else if (t != NULL) {
+        if (type == 1) {
+            task_wakeup(t, now_ns);
+        } else if (t->state != TASK_EXITED) {
+            task_switch_out(t, now_ns, "X");
+        }
+    }
+    return 1;
+}
+
+static int compare_arrival(const void *a, const void *b) {
+    const trace_task_t *x = *(trace_task_t *const *)a, *y = *(trace_task_t *const *)b;
+    if (x->arrival_ns != y->arrival_ns) return (x->arrival_ns > y->arrival_ns) - (x->arrival_ns < y->arrival_ns);
+    return (x->pid > y->pid) - (x->pid < y->pid);
+}
+
+// End the open bursts, write the remaining bursts and the scenario script
+static int finish(void) {
+    trace_task_t **order = malloc((num_tasks ? num_tasks : 1) * sizeof(trace_task_t *));
+    if (order == NULL) {
+        perror("malloc");
+        return -1;
+    }
+    size_t num_kept = 0, num_dropped = 0;
+    uint64_t bursts = 0;
+    for (size_t i = 0; i < tasks_capacity; i++) {
+        trace_task_t *t = &tasks[i];
+        if (t->pid == 0) continue;
+        if (t->state == TASK_RUNNING) t->cpu_ns += last_ns - t->run_start_ns;
+        if (t->cpu_ns > 0) emit_burst(t, 0);
+        if (t->total_cpu_ns < min_cpu_ns) {
+            // Too little CPU to matter in the simulation
+            if (t->file_created) {
+                char path[PATH_MAX];
+                task_path(t, path, sizeof(path));
+                unlink(path);
+            }
+            num_dropped++;
+            continue;
+        }
+        flush_task(t);
+        bursts += t->num_bursts;
+        order[num_kept++] = t;
+    }
+    qsort(order, num_kept, sizeof(trace_task_t *), compare_arrival);
+
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/%s", out_dir, SCRIPT_NAME);
+    FILE *script = fopen(path, "w");
+    if (script == NULL) {
+        perror(path);
+        free(order);
+        return -1;
+    }
+    fprintf(script, "#!/bin/bash\n");
+    fprintf(script, "# %zu tasks imported from a scheduler trace of %.3f s, started at the time they\n",
+            num_kept, (double)(last_ns - first_ns) / 1e9);
+    fprintf(script, "# appeared in the trace. Replay with: ./scheduler -r %s <scheduler>\n", path);
+    uint64_t at_ns = first_ns;
+    for (size_t i = 0; i < num_kept; i++) {
+        trace_task_t *t = order[i];
+        if (t->arrival_ns > at_ns) {
+            fprintf(script, "sleep %.3f\n", (double)(t->arrival_ns - at_ns) / 1e9);
+            at_ns = t->arrival_ns;
+        }
+        char name[COMM_LEN + 32];
+        task_file_name(t, name, sizeof(name));
+        fprintf(script, "./app-io %s/%s &\n", out_dir, name);
+    }
+    fprintf(script, "wait\n");
+    int ret = (fclose(script) == 0) ? 0 : -1;
+    if (ret != 0) perror(path);
+    chmod(path, 0755);
+
+    fprintf(stderr, "%" PRIu64 " events, %zu tasks with %" PRIu64 " bursts written to %s", num_events,
+            num_kept, bursts, out_dir);
+    if (num_dropped > 0) fprintf(stderr, ", %zu tasks with less than %" PRIu64 " ms of CPU dropped",
+                                 num_dropped, (uint64_t)(min_cpu_ns / NS_PER_MS));
+    if (ignored_tasks > 0) fprintf(stderr, ", %" PRIu64 " events of tasks over the limit of %zu ignored",
+                                   ignored_tasks, max_tasks);
+    if (num_unparsed > 0) fprintf(stderr, ", %" PRIu64 " events not understood", num_unparsed);
+    fprintf(stderr, "\n");
+    free(order);
+    return (ret == 0 && !write_failed) ? 0 : -1;
+}
+
+static void print_usage(const char *prog) {
+    printf("Usage: %s [-n max_tasks] [-s min_sleep_ms] [-m min_cpu_ms] -o out_dir <trace.txt|->\n", prog);
+}
+
+static long parse_option(const char *arg, char opt) {
+    char *endptr;
+    errno = 0;
+    long value = strtol(arg, &endptr, 10);
+    if (errno != 0 || *endptr != '\0' || value < 0) {
+        fprintf(stderr, "Invalid value for -%c: %s\n", opt, arg);
+        exit(EXIT_FAILURE);
+    }
+    return value;
+}
+
+int main(int argc, char *argv[]) {
+    int opt;
+    while ((opt = getopt(argc, argv, "n:s:m:o:")) != -1) {
+        switch (opt) {
+            case 'n':
+                max_tasks = (size_t)parse_option(optarg, 'n');
+                break;
+            case 's':
+                min_sleep_ns = (uint64_t)parse_option(optarg, 's') * NS_PER_MS;
+                break;
+            case 'm':
+                min_cpu_ns = (uint64_t)parse_option(optarg, 'm') * NS_PER_MS;
+                break;
+            case 'o':
+                out_dir = optarg;
+                break;
+            default:
+                print_usage(argv[0]);
+                exit(EXIT_FAILURE);
+        }
+    }
+    if (optind != argc - 1 || out_dir == NULL || max_tasks == 0) {
+        print_usage(argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    if (mkdir(out_dir, 0755) != 0 && errno != EEXIST) {
+        perror(out_dir);
+        exit(EXIT_FAILURE);
+    }
+    FILE *in = strcmp(argv[optind], "-") == 0 ? stdin : fopen(argv[optind], "r");
+    if (in == NULL) {
+        perror(argv[optind]);
+        exit(EXIT_FAILURE);
+    }
+
+    char line[MAX_LINE_LEN];
+    while (fgets(line, sizeof(line), in)) {
+        size_t len = strlen(line);
+        if (len == sizeof(line) - 1 && line[len - 1] != '\n') {
+            // Not an event of interest: skip the rest of the line
+            int c;
+            while ((c = fgetc(in)) != EOF && c != '\n') {}
+        }
+        if (line[0] == '#') continue;
+        int parsed = parse_line(line);
+        if (parsed > 0) {
+            num_events++;
+        } else if (parsed < 0) {
+            if (num_unparsed++ == 0) fprintf(stderr, "Event not understood, skipped: %s", line);
+        }
+    }
+    if (ferror(in)) perror(argv[optind]);
+    if (in != stdin) fclose(in);
+    if (num_events == 0 && num_unparsed > 0) {
+        // An empty workload would look like a success
+        fprintf(stderr, "None of the %" PRIu64 " scheduler events was understood, nothing imported\n", num_unparsed);
+        free(tasks);
+        return EXIT_FAILURE;
+    }
+
+    int ret = finish();
+    free(tasks);
+    return ret == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,427 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/*
+ * Parameter tuner: replays a set of scenarios with every combination of a grid of
+ * simulator parameters, running the simulations in parallel on the host cores,
+ * and prints the results and the Pareto front of mean turnaround, p99 response
+ * time, throughput and energy. With -b, the workloads are also run with a baseline
+ * scheduler (e.g. the oracle SJF when tuning SJF-EXP), and each point shows how
+ * much turnaround it loses or gains compared to it.
+ *
+ * Run like: ./tuner -w ../run_appsio.sh -g mlfq_quantum0_ms=100,250,500 -g mlfq_aging_period_ms=500,1000 MLFQ
+ */
+
+#define MAX_DIMS 8
+#define MAX_VALUES 32
+#define MAX_WORKLOADS 16
+#define MAX_POINTS 4096
+#define PARAM_NAME_LEN 64
+
+typedef enum {
+    OBJ_TURNAROUND = 0,     // Mean turnaround (lower is better)
+    OBJ_P99,                // 99th percentile of the burst response time (lower is better)
+    OBJ_THROUGHPUT,         // Bursts per second (higher is better)
+    OBJ_ENERGY,             // Energy of the CPUs (lower is better)
+} objective_en;
+
+static const char *OBJECTIVE_NAMES[] = {
+    "turnaround",
+    "p99",
+    "throughput",
+    "energy",
+    NULL
+};
+
+// A parameter and the values to try
+typedef struct {
+    char name[PARAM_NAME_LEN];
+    int num_values;
+    unsigned values[MAX_VALUES];
+} tune_dim_t;
+
+// A combination of parameter values and its results, averaged over the workloads
+typedef struct {
+    int index[MAX_DIMS];    // Index of the value of each parameter
+    double turnaround_ms;
+    double p99_ms;
+    double throughput;
+    double energy_j;
+    double response_ms;     // Mean response time of the CPU bursts
+    double context_switches;
+    int failed;
+    int pareto;             // Not dominated by any other point
+} tune_point_t;
+
+static tune_dim_t dims[MAX_DIMS];
+static int num_dims = 0;
+static const char *workloads[MAX_WORKLOADS];
+static int num_workloads = 0;
+static tune_point_t *points = NULL;
+static int num_points = 0;
+static objective_en objective = OBJ_TURNAROUND;
+static const char *baseline_policy = NULL;
+static tune_point_t baseline;           // Results of the baseline scheduler, with default parameters
+
+// The point of a job; the jobs after the grid are the baseline runs
+static tune_point_t *job_point(int job) {
+    return (job < num_points * num_workloads) ? &points[job / num_workloads] : &baseline;
+}
+
+static int parse_dim(const char *spec) {
+    if (num_dims >= MAX_DIMS) {
+        fprintf(stderr, "Too many parameters (max %d)\n", MAX_DIMS);
+        return -1;
+    }
+    const char *eq = strchr(spec, '=');
+    if (eq == NULL || eq == spec || (size_t)(eq - spec) >= PARAM_NAME_LEN) {
+        fprintf(stderr, "Invalid grid %s, expected name=value,value,...\n", spec);
+        return -1;
+    }
+    tune_dim_t *dim = &dims[num_dims];
+    memcpy(dim->name, spec, (size_t)(eq - spec));
+    dim->name[eq - spec] = '\0';
+    dim->num_values = 0;
+
+    const char *p = eq + 1;
+    while (*p != '\0') {
+        char *endptr;
+        errno = 0;
+        long val = strtol(p, &endptr, 10);
+        if (errno != 0 || endptr == p || val < 0 || val > INT_MAX || (*endptr != ',' && *endptr != '\0')) {
+            fprintf(stderr, "Invalid value in grid %s\n", spec);
+            return -1;
+        }
+        if (dim->num_values >= MAX_VALUES) {
+            fprintf(stderr, "Too many values for %s (max %d)\n", dim->name, MAX_VALUES);
+            return -1;
+        }
+        dim->values[dim->num_values++] = (unsigned)val;
+        p = (*endptr == ',') ? endptr + 1 : endptr;
+    }
+    if (dim->num_values == 0) {
+        fprintf(stderr, "No values for %s\n", dim->name);
+        return -1;
+    }
+    num_dims++;
+    return 0;
+}
+
+// Build the cartesian product of the values of all parameters
+static int build_grid(void) {
+    long total = 1;
+    for (int d = 0; d < num_dims; d++) {
+        total *= dims[d].num_values;
+        if (total > MAX_POINTS) {
+            fprintf(stderr, "The grid has too many points (max %d)\n", MAX_POINTS);
+            return -1;
+        }
+    }
+    points = calloc((size_t)total, sizeof(tune_point_t));
+    if (!points) {
+        perror("calloc");
+        return -1;
+    }
+    num_points = (int)total;
+    for (int i = 0; i < num_points; i++) {
+        int rest = i;
+        for (int d = num_dims - 1; d >= 0; d--) {
+            points[i].index[d] = rest % dims[d].num_values;
+            rest /= dims[d].num_values;
+        }
+    }
+    return 0;
+}
+
+static void report_path(char *out, size_t size, int job) {
+    snprintf(out, size, "/tmp/ossim-tune-%d-%d.txt", (int)getpid(), job);
+}
+
+// Start the simulation of a point with a workload, returning the pid of the child
+static pid_t start_job(const char *scheduler, const char *policy, int job) {
+    const tune_point_t *pt = job_point(job);
+    int is_baseline = (pt == &baseline);
+    char report[PATH_MAX];
+    report_path(report, sizeof(report), job);
+
+    char params[MAX_DIMS][PARAM_NAME_LEN + 16];
+    char *args[2 * MAX_DIMS + 8];
+    int n = 0;
+    args[n++] = (char *)scheduler;
+    for (int d = 0; d < num_dims && !is_baseline; d++) {
+        snprintf(params[d], sizeof(params[d]), "%s=%u", dims[d].name, dims[d].values[pt->index[d]]);
+        args[n++] = "-p";
+        args[n++] = params[d];
+    }
+    args[n++] = "-r";
+    args[n++] = (char *)workloads[job % num_workloads];
+    args[n++] = "-o";
+    args[n++] = report;
+    args[n++] = (char *)(is_baseline ? baseline_policy : policy);
+    args[n] = NULL;
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        // The output of the simulation is not interesting here (a failure shows in the results)
+        int devnull = open("/dev/null", O_WRONLY);
+        if (devnull >= 0) {
+            dup2(devnull, STDOUT_FILENO);
+            dup2(devnull, STDERR_FILENO);
+            close(devnull);
+        }
+        execv(scheduler, args);
+        perror("execv");
+        _exit(127);
+    }
+    if (pid < 0) perror("fork");
+    return pid;
+}
+
+// Add the metrics of a report to its point
+static void collect_job(int job, int status) {
+    tune_point_t *pt = job_point(job);
+    char report[PATH_MAX];
+    report_path(report, sizeof(report), job);
+
+    double turnaround_ms = 0, p99_ms = 0, throughput = 0, energy_j = 0, response_ms = 0, context_switches = 0;
+    int found = 0;
+    FILE *file = NULL;
+    if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+        file = fopen(report, "r");
+    }
+    if (file) {
+        char line[256];
+        while (fgets(line, sizeof(line), file)) {
+            found += sscanf(line, "Mean turnaround: %lf", &turnaround_ms);
+            found += sscanf(line, "Response p99: %lf", &p99_ms);
+            found += sscanf(line, "Throughput: %lf", &throughput);
+            found += sscanf(line, "Energy: %lf", &energy_j);
+            found += sscanf(line, "Response mean: %lf", &response_ms);
+            found += sscanf(line, "Context switches: %lf", &context_switches);
+        }
+        fclose(file);
+    }
+    unlink(report);
+    if (found != 6) {
+        pt->failed = 1;
+        return;
+    }
+    pt->turnaround_ms += turnaround_ms / num_workloads;
+    pt->p99_ms += p99_ms / num_workloads;
+    pt->throughput += throughput / num_workloads;
+    pt->energy_j += energy_j / num_workloads;
+    pt->response_ms += response_ms / num_workloads;
+    pt->context_switches += context_switches / num_workloads;
+}
+
+// Run all simulations, at most max_jobs at the same time
+static int run_all(const char *scheduler, const char *policy, int max_jobs) {
+    int total_jobs = num_points * num_workloads + (baseline_policy ? num_workloads : 0);
+    pid_t *running = calloc((size_t)max_jobs, sizeof(pid_t));
+    int *running_job = calloc((size_t)max_jobs, sizeof(int));
+    if (!running || !running_job) {
+        perror("calloc");
+        free(running);
+        free(running_job);
+        return -1;
+    }
+    int next_job = 0, num_running = 0, done = 0;
+    while (done < total_jobs) {
+        while (num_running < max_jobs && next_job < total_jobs) {
+            pid_t pid = start_job(scheduler, policy, next_job);
+            if (pid < 0) {
+                job_point(next_job)->failed = 1;
+                next_job++;
+                done++;
+                continue;
+            }
+            running[num_running] = pid;
+            running_job[num_running] = next_job++;
+            num_running++;
+        }
+        if (num_running == 0) break;
+
+        int status;
+        pid_t pid = wait(&status);
+        if (pid < 0) {
+            if (errno == EINTR) continue;
+            perror("wait");
+            break;
+        }
+        for (int i = 0; i < num_running; i++) {
+            if (running[i] == pid) {
+                collect_job(running_job[i], status);
+                running[i] = running[--num_running];
+                running_job[i] = running_job[num_running];
+                done++;
+                break;
+            }
+        }
+        if (done % 50 == 0 || done == total_jobs) {
+            fprintf(stderr, "\r%d/%d simulations", done, total_jobs);
+        }
+    }
+    fprintf(stderr, "\n");
+    free(running);
+    free(running_job);
+    return 0;
+}
+
+// a dominates b if it is not worse in any metric and better in at least one
+static int dominates(const tune_point_t *a, const tune_point_t *b) {
+    if (a->turnaround_ms > b->turnaround_ms || a->p99_ms > b->p99_ms || a->throughput < b->throughput ||
+        a->energy_j > b->energy_j) {
+        return 0;
+    }
+    return a->turnaround_ms < b->turnaround_ms || a->p99_ms < b->p99_ms || a->throughput > b->throughput ||
+           a->energy_j < b->energy_j;
+}
+
+static void mark_pareto_front(void) {
+    for (int i = 0; i < num_points; i++) {
+        if (points[i].failed) continue;
+        points[i].pareto = 1;
+        for (int j = 0; j < num_points && points[i].pareto; j++) {
+            if (j != i && !points[j].failed && dominates(&points[j], &points[i])) {
+                points[i].pareto = 0;
+            }
+        }
+    }
+}
+
+static double objective_value(const tune_point_t *pt) {
+    switch (objective) {
+        case OBJ_P99:
+            return pt->p99_ms;
+        case OBJ_THROUGHPUT:
+            return -pt->throughput;
+        case OBJ_ENERGY:
+            return pt->energy_j;
+        case OBJ_TURNAROUND:
+        default:
+            return pt->turnaround_ms;
+    }
+}
+
+// Best points first, failed ones last
+static int compare_points(const void *a, const void *b) {
+    const tune_point_t *x = a, *y = b;
+    if (x->failed != y->failed) return x->failed - y->failed;
+    double vx = objective_value(x), vy = objective_value(y);
+    return (vx > vy) - (vx < vy);
+}
+
+static void print_point(const tune_point_t *pt) {
+    for (int d = 0; d < num_dims && pt != &baseline; d++) {
+        printf("%s=%-6u ", dims[d].name, dims[d].values[pt->index[d]]);
+    }
+    if (pt->failed) {
+        printf("failed\n");
+        return;
+    }
+    printf("turnaround %.1f ms, p99 %.1f ms, throughput %.3f bursts/s, energy %.3f J, "
+           "response %.1f ms, %.0f context switches",
+           pt->turnaround_ms, pt->p99_ms, pt->throughput, pt->energy_j, pt->response_ms, pt->context_switches);
+    if (baseline_policy && !baseline.failed && baseline.turnaround_ms > 0 && pt != &baseline) {
+        printf(" (%+.1f%% turnaround, %+.1f%% response, %+.1f%% context switches vs %s)",
+               100.0 * (pt->turnaround_ms / baseline.turnaround_ms - 1.0),
+               baseline.response_ms > 0 ? 100.0 * (pt->response_ms / baseline.response_ms - 1.0) : 0.0,
+               baseline.context_switches > 0 ? 100.0 * (pt->context_switches / baseline.context_switches - 1.0) : 0.0,
+               baseline_policy);
+    }
+    printf("%s\n", pt->pareto ? " *" : "");
+}
+
+static void print_usage(const char *prog) {
+    printf("Usage: %s [-x scheduler] [-j jobs] [-O turnaround|p99|throughput|energy] [-b baseline] "
+           "-w scenario.sh... -g name=value,value,...... <scheduler>\n", prog);
+}
+
+int main(int argc, char *argv[]) {
+    char scheduler[PATH_MAX];
+    const char *slash = strrchr(argv[0], '/');
+    snprintf(scheduler, sizeof(scheduler), "%.*sscheduler", slash ? (int)(slash - argv[0] + 1) : 0, argv[0]);
+    long max_jobs = sysconf(_SC_NPROCESSORS_ONLN);
+
+    int opt;
+    while ((opt = getopt(argc, argv, "x:j:O:b:w:g:")) != -1) {
+        switch (opt) {
+            case 'x':
+                snprintf(scheduler, sizeof(scheduler), "%s", optarg);
+                break;
+            case 'j':
+                max_jobs = strtol(optarg, NULL, 10);
+                break;
+            case 'O': {
+                int i;
+                for (i = 0; OBJECTIVE_NAMES[i] != NULL; i++) {
+                    if (strcmp(optarg, OBJECTIVE_NAMES[i]) == 0) break;
+                }
+                if (OBJECTIVE_NAMES[i] == NULL) {
+                    fprintf(stderr, "Unknown objective %s\n", optarg);
+                    exit(EXIT_FAILURE);
+                }
+                objective = (objective_en)i;
+                break;
+            }
+            case 'b':
+                baseline_policy = optarg;
+                break;
+            case 'w':
+                if (num_workloads >= MAX_WORKLOADS) {
+                    fprintf(stderr, "Too many workloads (max %d)\n", MAX_WORKLOADS);
+                    exit(EXIT_FAILURE);
+                }
+                workloads[num_workloads++] = optarg;
+                break;
+            case 'g':
+                if (parse_dim(optarg) != 0) {
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            default:
+                print_usage(argv[0]);
+                exit(EXIT_FAILURE);
+        }
+    }
+    if (optind != argc - 1 || num_workloads == 0 || num_dims == 0) {
+        print_usage(argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    if (max_jobs < 1) max_jobs = 1;
+    const char *policy = argv[optind];
+
+    if (build_grid() != 0) {
+        return EXIT_FAILURE;
+    }
+    fprintf(stderr, "Tuning %s: %d points x %d workloads, %ld parallel jobs\n",
+            policy, num_points, num_workloads, max_jobs);
+    if (run_all(scheduler, policy, (int)max_jobs) != 0) {
+        free(points);
+        return EXIT_FAILURE;
+    }
+
+    mark_pareto_front();
+    qsort(points, (size_t)num_points, sizeof(tune_point_t), compare_points);
+    if (baseline_policy) {
+        printf("Baseline %s: ", baseline_policy);
+        print_point(&baseline);
+        printf("\n");
+    }
+    printf("All points, by %s (* = Pareto front):\n", OBJECTIVE_NAMES[objective]);
+    for (int i = 0; i < num_points; i++) {
+        print_point(&points[i]);
+    }
+    printf("\nPareto front (turnaround, p99, throughput, energy), by %s:\n", OBJECTIVE_NAMES[objective]);
+    for (int i = 0; i < num_points; i++) {
+        if (points[i].pareto) print_point(&points[i]);
+    }
+    free(points);
+    return EXIT_SUCCESS;
+}